@@ -1,46 +1,24 @@
-#include <emscripten.h>
-#include <emscripten/bind.h>
-#include <array>
-#include <string>
-#include <utility>
-
-extern "C" {
-#include <ccv.h>
-#include <ccv_internal.h>
-}
-
-using namespace emscripten;
+// Core bindings: matrix I/O, basic filters, classics, pipelines and motion gating.
+// Each detector is in its own ccv_bindings_<detector>.cpp.
+#include "ccv_bindings.h"
 
 int main() {
   ccv_enable_default_cache();
 }
 
-const ccv_mser_param_t ccv_mser_default_params = { // From ccv/bin/msermatch.c
-  .min_area = 60,
-  .max_area = 10000, // Changed
-  .min_diversity = 0.2,
-  .area_threshold = 1.01,
-  .min_margin = 0.003,
-  .max_evolution = 200,
-  .edge_blur_sigma = sqrt(3.0),
-  .delta = 5,
-  .max_variance = 0.25,
-  .direction = CCV_DARK_TO_BRIGHT,
-};
-
 typedef struct { // See ccv_tld_param_t
   ccv_size_t win_size;
   int level;
   float min_eigen;
 } ccv_lucas_kanade_param_t;
 
-const ccv_lucas_kanade_param_t ccv_lucas_kanade_default_params = {
+const ccv_lucas_kanade_param_t ccv_lucas_kanade_default_params = { // Same as ccv_tld_default_params, copied so the core doesn't link ccv_tld
   .win_size = {
-    .width = ccv_tld_default_params.win_size.width,
-    .height = ccv_tld_default_params.win_size.height
+    .width = 15,
+    .height = 15
   },
-  .level = ccv_tld_default_params.level,
-  .min_eigen = ccv_tld_default_params.min_eigen,
+  .level = 5,
+  .min_eigen = 0.025,
 };
 
 
@@ -127,95 +105,11 @@ int ccv_read_html(const val& imageDataOrCanvasImageSource, ccv_dense_matrix_t**
 }
 
 
-// Wrap ccv_array_t with type information
-template<typename T>
-struct CCVArray : public ccv_array_t {
-  static std::shared_ptr<CCVArray<T>> fromJS(val jsArray) {
-    int length = jsArray["length"].as<int>();
-    auto array = make_shared_with_delete((CCVArray<T>*)ccv_array_new(sizeof(T), length, 0));
-    for (int i = 0; i < length; i++) {
-      T temp = jsArray[i].as<T>();
-      ccv_array_push(array.get(), &temp);
-    }
-    return array;
-  }
-
-  void push(const T& x) {
-    ccv_array_push(this, &x);
-  }
-
-  const T& get(int i) const {
-    return *(T*)ccv_array_get(this, i);
-  }
-
-  val toJS() const {
-    val jsArray = val::array();
-    for (int i = 0; i < this->rnum; i++) {
-      jsArray.call<void>("push", val(*(T*)ccv_array_get(this, i)));
-    }
-    return jsArray;
-  }
-};
-
-
-// Deleters
-template<typename T>
-struct Deleter { // Default deleter, probably only used by ccv_tld_info_t
-  void operator()(T* ptr) {
-    //printf("%p %s default freed\n", ptr, typeid(T).name());
-    delete ptr;
-  }
-};
-template<>
-struct Deleter<ccv_dense_matrix_t> {
-  void operator()(ccv_dense_matrix_t* ptr) {
-    //printf("%p %s freed\n", ptr, typeid(ccv_dense_matrix_t).name());
-    ccv_matrix_free(ptr);
-  }
-};
-template<typename T>
-struct Deleter<CCVArray<T>> {
-  void operator()(CCVArray<T>* ptr) {
-    //printf("%p %s freed\n", ptr, typeid(CCVArray<T>).name());
-    ccv_array_free(ptr);
-  }
-};
-template<>
-struct Deleter<ccv_tld_t> {
-  void operator()(ccv_tld_t* ptr) {
-    //printf("%p %s freed\n", ptr, typeid(ccv_tld_t).name());
-    ccv_tld_free(ptr);
-  }
-};
-template<>
-struct Deleter<ccv_dpm_mixture_model_t> {
-  void operator()(ccv_dpm_mixture_model_t* ptr) {
-    //printf("%p %s freed\n", ptr, typeid(ccv_dpm_mixture_model_t).name());
-    ccv_dpm_mixture_model_free(ptr);
-  }
-};
-template<>
-struct Deleter<ccv_icf_classifier_cascade_t> {
-  void operator()(ccv_icf_classifier_cascade_t* ptr) {
-    //printf("%p %s freed\n", ptr, typeid(ccv_icf_classifier_cascade_t).name());
-    ccv_icf_classifier_cascade_free(ptr);
-  }
-};
-template<>
-struct Deleter<ccv_scd_classifier_cascade_t> {
-  void operator()(ccv_scd_classifier_cascade_t* ptr) {
-    //printf("%p %s freed\n", ptr, typeid(ccv_scd_classifier_cascade_t).name());
-    ccv_scd_classifier_cascade_free(ptr);
-  }
-};
-
+int live_allocation_count = 0;
 
-// Takes ownership of a raw pointer and adds the correct deleter for that type
-template<typename T>
-auto make_shared_with_delete(T* ptr) {
-  //printf("%p %s alloced\n", ptr, typeid(T).name());
-  return std::shared_ptr<T>(ptr, Deleter<T>());
-};
+int get_live_allocation_count() {
+  return live_allocation_count;
+}
 
 
 
@@ -253,33 +147,6 @@ val ccv_dense_matrix_t_get_data(const std::shared_ptr<ccv_dense_matrix_t>& point
   }
 }
 
-template<typename T>
-void CCVArray_push(const std::shared_ptr<CCVArray<T>>& ptr, const T& x) {
-  ptr->push(x);
-}
-template<typename T>
-const T& CCVArray_get(const std::shared_ptr<CCVArray<T>>& ptr, int i) {
-  return ptr->get(i);
-}
-template<typename T>
-int CCVArray_get_rnum(const std::shared_ptr<CCVArray<T>>& ptr) {
-  return ptr->rnum;
-}
-template<typename T>
-val CCVArray_toJS(const std::shared_ptr<CCVArray<T>>& ptr) {
-  return ptr->toJS();
-}
-
-
-val ccv_tld_t_get_top(const std::shared_ptr<ccv_tld_t>& ptr) {
-  // Can't just return the ccv_array_t* as a shared_ptr like everywhere else because don't want to take ownership
-  val jsarray = val::array();
-  for (int i = 0; i < ptr->top->rnum; i++) {
-    jsarray.call<void>("push", val(*(ccv_comp_t*)ccv_array_get(ptr->top, i)));
-  }
-  return jsarray;
-}
-
 
 // int ccv_read(const char *in, ccv_dense_matrix_t **x, int type)
 int ccvjs_read(val source, std::shared_ptr<ccv_dense_matrix_t>& out, int type) {
@@ -297,130 +164,6 @@ int ccvjs_write(const std::shared_ptr<ccv_dense_matrix_t>& mat, val out) {
   return ccv_write_html(mat.get(), out);
 }
 
-// ccv_tld_t* ccv_tld_new(ccv_dense_matrix_t* a, ccv_rect_t box, ccv_tld_param_t params);
-std::shared_ptr<ccv_tld_t> ccvjs_tld_new(const std::shared_ptr<ccv_dense_matrix_t>& a, ccv_rect_t box, ccv_tld_param_t params = ccv_tld_default_params) {
-  return make_shared_with_delete(ccv_tld_new(a.get(), box, params));
-}
-
-// ccv_comp_t ccv_tld_track_object(ccv_tld_t* tld, ccv_dense_matrix_t* a, ccv_dense_matrix_t* b, ccv_tld_info_t* info);
-ccv_comp_t ccvjs_tld_track_object(const std::shared_ptr<ccv_tld_t>& tld, const std::shared_ptr<ccv_dense_matrix_t>& a, const std::shared_ptr<ccv_dense_matrix_t>& b, const std::shared_ptr<ccv_tld_info_t>& info) {
-  return ccv_tld_track_object(tld.get(), a.get(), b.get(), info.get());
-}
-
-// ccv_array_t* ccv_swt_detect_words(ccv_dense_matrix_t* a, ccv_swt_param_t params);
-std::shared_ptr<CCVArray<ccv_rect_t>> ccvjs_swt_detect_words(const std::shared_ptr<ccv_dense_matrix_t>& a, ccv_swt_param_t params = ccv_swt_default_params) {
-  return make_shared_with_delete((CCVArray<ccv_rect_t>*)ccv_swt_detect_words(a.get(), params));
-}
-
-// void ccv_sift(ccv_dense_matrix_t* a, ccv_array_t** keypoints, ccv_dense_matrix_t** desc, int type, ccv_sift_param_t params);
-void ccvjs_sift(const std::shared_ptr<ccv_dense_matrix_t>& a, std::shared_ptr<CCVArray<ccv_keypoint_t>>& keypoints, std::shared_ptr<ccv_dense_matrix_t>& desc, int type, ccv_sift_param_t params = ccv_sift_default_params) {
-  ccv_array_t* keypoints_ptr = nullptr;
-  ccv_dense_matrix_t* desc_ptr = nullptr;
-  ccv_sift(a.get(), &keypoints_ptr, &desc_ptr, type, params);
-  keypoints = make_shared_with_delete((CCVArray<ccv_keypoint_t>*)keypoints_ptr);
-  desc = make_shared_with_delete(desc_ptr);
-}
-
-// From ccv/bin/siftmatch.c
-val ccvjs_sift_match(const std::shared_ptr<ccv_dense_matrix_t>& desc1, const std::shared_ptr<CCVArray<ccv_keypoint_t>>& kp1, const std::shared_ptr<ccv_dense_matrix_t>& desc2, const std::shared_ptr<CCVArray<ccv_keypoint_t>>& kp2) {
-  double ratio = 0.36;
-
-  ccv_array_t* image_keypoints = kp1.get();
-  ccv_dense_matrix_t* image_desc = desc1.get();
-  ccv_array_t* obj_keypoints = kp2.get();
-  ccv_dense_matrix_t* obj_desc = desc2.get();
-
-  int i, j, k;
-  val matches = val::array();
-  for (i = 0; i < obj_keypoints->rnum; i++) {
-    float* odesc = obj_desc->data.f32 + i * 128;
-    int minj = -1;
-    double mind = 1e6, mind2 = 1e6;
-    for (j = 0; j < image_keypoints->rnum; j++) {
-      float* idesc = image_desc->data.f32 + j * 128;
-      double d = 0;
-      for (k = 0; k < 128; k++) {
-        d += (odesc[k] - idesc[k]) * (odesc[k] - idesc[k]);
-        if (d > mind2)
-          break;
-      }
-      if (d < mind) {
-        mind2 = mind;
-        mind = d;
-        minj = j;
-      } else if (d < mind2) {
-        mind2 = d;
-      }
-    }
-    if (mind < mind2 * ratio) {
-      //ccv_keypoint_t* op = (ccv_keypoint_t*)ccv_array_get(obj_keypoints, i);
-      //ccv_keypoint_t* kp = (ccv_keypoint_t*)ccv_array_get(image_keypoints, minj);
-      val pair = val::array();
-      pair.call<void>("push", minj);
-      pair.call<void>("push", i);
-      matches.call<void>("push", pair);
-    }
-  }
-  return matches;
-}
-
-
-#ifdef WITH_FILESYSTEM
-
-template<typename T>
-std::vector<T*> vectorFromJS(val jsArray) {
-  assert(val::global("Array").call<bool>("isArray", jsArray));
-  int length = jsArray["length"].as<int>();
-  std::vector<T*> vec;
-  for (int i = 0; i < length; i++) {
-    vec.push_back(jsArray[i].as<std::shared_ptr<T>>().get());
-  }
-  return vec;
-}
-
-// ccv_scd_classifier_cascade_t* ccv_scd_classifier_cascade_read(const char* filename);
-std::shared_ptr<ccv_scd_classifier_cascade_t> ccvjs_scd_classifier_cascade_read(const std::string& filename) {
-  return make_shared_with_delete(ccv_scd_classifier_cascade_read(filename.c_str()));
-}
-
-// ccv_array_t* ccv_scd_detect_objects(ccv_dense_matrix_t* a, ccv_scd_classifier_cascade_t** cascades, int count, ccv_scd_param_t params);
-std::shared_ptr<CCVArray<ccv_rect_t>> ccvjs_scd_detect_objects(const std::shared_ptr<ccv_dense_matrix_t>& a, val cascadeJSArray, int count, ccv_scd_param_t params = ccv_scd_default_params) {
-  auto vec = vectorFromJS<ccv_scd_classifier_cascade_t>(cascadeJSArray);
-  return make_shared_with_delete((CCVArray<ccv_rect_t>*)ccv_scd_detect_objects(a.get(), vec.data(), vec.size(), params));
-}
-
-// ccv_icf_classifier_cascade_t* ccv_icf_read_classifier_cascade(const char* filename);
-std::shared_ptr<ccv_icf_classifier_cascade_t> ccvjs_icf_read_classifier_cascade(const std::string& filename) {
-  return make_shared_with_delete(ccv_icf_read_classifier_cascade(filename.c_str()));
-}
-
-// ccv_array_t* ccv_icf_detect_objects(ccv_dense_matrix_t* a, void* cascade, int count, ccv_icf_param_t params);
-std::shared_ptr<CCVArray<ccv_comp_t>> ccvjs_icf_detect_objects(const std::shared_ptr<ccv_dense_matrix_t>& a, val cascadeJSArray, int count, ccv_icf_param_t params = ccv_icf_default_params) {
-  auto vec = vectorFromJS<ccv_icf_classifier_cascade_t>(cascadeJSArray);
-  return make_shared_with_delete((CCVArray<ccv_comp_t>*)ccv_icf_detect_objects(a.get(), vec.data(), vec.size(), params));
-}
-
-// ccv_dpm_mixture_model_t* ccv_dpm_read_mixture_model(const char* directory);
-std::shared_ptr<ccv_dpm_mixture_model_t> ccvjs_dpm_read_mixture_model(std::string directory) {
-  return make_shared_with_delete(ccv_dpm_read_mixture_model(directory.c_str()));
-}
-
-// ccv_array_t* ccv_dpm_detect_objects(ccv_dense_matrix_t* a, ccv_dpm_mixture_model_t** model, int count, ccv_dpm_param_t params);
-std::shared_ptr<CCVArray<ccv_root_comp_t>> ccvjs_dpm_detect_objects(const std::shared_ptr<ccv_dense_matrix_t>& a, val modelJSArray, int count, ccv_dpm_param_t params = ccv_dpm_default_params) {
-  auto vec = vectorFromJS<ccv_dpm_mixture_model_t>(modelJSArray);
-  return make_shared_with_delete((CCVArray<ccv_root_comp_t>*)ccv_dpm_detect_objects(a.get(), vec.data(), vec.size(), params));
-}
-
-#endif // WITH_FILESYSTEM
-
-// ccv_array_t* ccv_mser(ccv_dense_matrix_t* a, ccv_dense_matrix_t* h, ccv_dense_matrix_t** b, int type, ccv_mser_param_t params);
-std::shared_ptr<CCVArray<ccv_mser_keypoint_t>> ccvjs_mser(const std::shared_ptr<ccv_dense_matrix_t>& a, const std::shared_ptr<ccv_dense_matrix_t>& h, std::shared_ptr<ccv_dense_matrix_t>& b, int type, ccv_mser_param_t params = ccv_mser_default_params) {
-  ccv_dense_matrix_t* b_ptr = nullptr;
-  ccv_array_t* ret = ccv_mser(a.get(), h.get(), &b_ptr, type, params);
-  b = make_shared_with_delete(b_ptr);
-  return make_shared_with_delete((CCVArray<ccv_mser_keypoint_t>*)ret);
-}
-
 // void ccv_canny(ccv_dense_matrix_t *a, ccv_dense_matrix_t **b, int type, int size, double low_thresh, double high_thresh)
 void ccvjs_canny(const std::shared_ptr<ccv_dense_matrix_t>& a, std::shared_ptr<ccv_dense_matrix_t>& b, int type, int size, double low_thresh, double high_thresh) {
   ccv_dense_matrix_t* b_ptr = nullptr;
@@ -474,31 +217,380 @@ void ccvjs_optical_flow_lucas_kanade(const std::shared_ptr<ccv_dense_matrix_t>&
 }
 
 
-template<typename T>
-void register_ccv_array(const char* name) {
-  class_<CCVArray<T>, base<ccv_array_t>>(name)
-    .smart_ptr_constructor("shared_ptr<ccv_array_t>", &std::make_shared<CCVArray<T>>)
-    .class_function("fromJS", &CCVArray<T>::fromJS)
-    // TODO: Should bind directly to the member functions of CCVArray<T> but doing so seems to hit a bug
-    // where it will keep using the stale pointer in the shared_ptr even after being changed.
-    // Wrapping the functions seems to avoid the problem.
-    // https://github.com/kripken/emscripten/issues/4583
-    .function("getLength", &CCVArray_get_rnum<T>)
-    .function("get", &CCVArray_get<T>)
-    .function("push", &CCVArray_push<T>)
-    .function("toJS", &CCVArray_toJS<T>);
+// A chain of image processing calls that runs in one call per frame. Node 0 is the frame read by ccv_pipeline_run and
+// every op can only take earlier nodes as input so the nodes are already in execution order.
+// The matrices of each node are kept between runs. After the first run of a given frame size the output shape of every
+// node is known, so nodes whose lifetimes don't overlap get to share a matrix (ping-ponging down a chain) and later runs
+// don't allocate any matrices.
+struct ccv_pipeline_t {
+  enum op_t { INPUT, SAMPLE_DOWN, BLUR, CANNY, CLOSE_OUTLINE, FLIP, MSER };
+  struct node_t {
+    op_t op;
+    int a; // Index of the input node
+    int h; // Index of the second input node (ccv_mser only, -1 if unused)
+    int type;
+    int src_x; // ccv_sample_down
+    int src_y;
+    double sigma; // ccv_blur
+    int size; // ccv_canny
+    double low_thresh;
+    double high_thresh;
+    int flip; // ccv_flip
+    ccv_mser_param_t mser_params; // ccv_mser
+  };
+
+  std::vector<node_t> nodes = { node_t{INPUT, -1, -1} };
+  std::vector<int> outputs;
+
+  // Which matrix in slots each node writes to. Only valid for frames with the planned size and type.
+  std::vector<int> slot_of_node;
+  std::vector<std::shared_ptr<ccv_dense_matrix_t>> slots;
+  int planned_rows = -1;
+  int planned_cols = -1;
+  int planned_type = -1;
+
+  int add(node_t node) {
+    assert(node.a >= 0 && node.a < (int)nodes.size());
+    assert(node.h < (int)nodes.size());
+    nodes.push_back(node);
+    invalidate();
+    return nodes.size() - 1;
+  }
+
+  void invalidate() {
+    slot_of_node.clear();
+    slots.clear();
+    planned_rows = planned_cols = planned_type = -1;
+  }
+};
+
+int ccv_pipeline_t_sample_down(const std::shared_ptr<ccv_pipeline_t>& pipeline, int a, int type, int src_x, int src_y) {
+  ccv_pipeline_t::node_t node = {ccv_pipeline_t::SAMPLE_DOWN, a, -1, type};
+  node.src_x = src_x;
+  node.src_y = src_y;
+  return pipeline->add(node);
+}
+int ccv_pipeline_t_blur(const std::shared_ptr<ccv_pipeline_t>& pipeline, int a, int type, double sigma) {
+  ccv_pipeline_t::node_t node = {ccv_pipeline_t::BLUR, a, -1, type};
+  node.sigma = sigma;
+  return pipeline->add(node);
+}
+int ccv_pipeline_t_canny(const std::shared_ptr<ccv_pipeline_t>& pipeline, int a, int type, int size, double low_thresh, double high_thresh) {
+  ccv_pipeline_t::node_t node = {ccv_pipeline_t::CANNY, a, -1, type};
+  node.size = size;
+  node.low_thresh = low_thresh;
+  node.high_thresh = high_thresh;
+  return pipeline->add(node);
+}
+int ccv_pipeline_t_close_outline(const std::shared_ptr<ccv_pipeline_t>& pipeline, int a, int type) {
+  ccv_pipeline_t::node_t node = {ccv_pipeline_t::CLOSE_OUTLINE, a, -1, type};
+  return pipeline->add(node);
+}
+int ccv_pipeline_t_flip(const std::shared_ptr<ccv_pipeline_t>& pipeline, int a, int btype, int type) {
+  ccv_pipeline_t::node_t node = {ccv_pipeline_t::FLIP, a, -1, btype};
+  node.flip = type;
+  return pipeline->add(node);
+}
+int ccv_pipeline_t_mser(const std::shared_ptr<ccv_pipeline_t>& pipeline, int a, int h, int type, ccv_mser_param_t params) {
+  ccv_pipeline_t::node_t node = {ccv_pipeline_t::MSER, a, h, type};
+  node.mser_params = params;
+  return pipeline->add(node);
+}
+void ccv_pipeline_t_output(const std::shared_ptr<ccv_pipeline_t>& pipeline, int i) {
+  assert(i >= 0 && i < (int)pipeline->nodes.size());
+  pipeline->outputs.push_back(i);
+  pipeline->invalidate(); // Outputs have to stay alive until the end of the run
+}
+
+bool ccv_pipeline_same_shape(ccv_dense_matrix_t* a, ccv_dense_matrix_t* b) {
+  return (
+    a->rows == b->rows &&
+    a->cols == b->cols &&
+    CCV_GET_DATA_TYPE(a->type) == CCV_GET_DATA_TYPE(b->type) &&
+    CCV_GET_CHANNEL(a->type) == CCV_GET_CHANNEL(b->type)
+  );
+}
+
+// Index of the last node that reads each node's matrix
+std::vector<int> ccv_pipeline_last_use(const ccv_pipeline_t* pipeline) {
+  int n = pipeline->nodes.size();
+  std::vector<int> last_use(n, -1);
+  for (int i = 1; i < n; i++) {
+    last_use[pipeline->nodes[i].a] = i;
+    if (pipeline->nodes[i].h >= 0) {
+      last_use[pipeline->nodes[i].h] = i;
+    }
+  }
+  for (int i : pipeline->outputs) {
+    last_use[i] = n; // Returned to js so must survive the whole run
+  }
+  return last_use;
+}
+
+// ccv_flip flips its input in place when it isn't given an output, so a flip that keeps the type can take over the
+// matrix of its input once nothing after it reads that. The other ops always need a separate output.
+bool ccv_pipeline_in_place(const ccv_pipeline_t* pipeline, const std::vector<int>& last_use, int i) {
+  const ccv_pipeline_t::node_t& node = pipeline->nodes[i];
+  return node.op == ccv_pipeline_t::FLIP && node.type == 0 && last_use[node.a] == i;
+}
+
+// Greedily assigns each node a slot whose previous owner has already been consumed by an earlier node and has the same
+// shape. In place nodes share the slot of their input (none for the frame itself, which is read fresh every run).
+void ccv_pipeline_plan(ccv_pipeline_t* pipeline, const std::vector<std::shared_ptr<ccv_dense_matrix_t>>& matrices) {
+  int n = pipeline->nodes.size();
+  std::vector<int> last_use = ccv_pipeline_last_use(pipeline);
+
+  std::vector<int> slot_last_use;
+  pipeline->slot_of_node.assign(n, -1);
+  pipeline->slots.clear();
+  for (int i = 1; i < n; i++) {
+    if (ccv_pipeline_in_place(pipeline, last_use, i)) {
+      int slot = pipeline->slot_of_node[pipeline->nodes[i].a];
+      if (slot >= 0) {
+        slot_last_use[slot] = last_use[i];
+      }
+      pipeline->slot_of_node[i] = slot;
+      continue;
+    }
+    int slot = -1;
+    for (int j = 0; j < (int)pipeline->slots.size(); j++) {
+      if (slot_last_use[j] < i && ccv_pipeline_same_shape(pipeline->slots[j].get(), matrices[i].get())) {
+        slot = j;
+        break;
+      }
+    }
+    if (slot == -1) {
+      slot = pipeline->slots.size();
+      pipeline->slots.push_back(matrices[i]);
+      slot_last_use.push_back(-1);
+    }
+    slot_last_use[slot] = last_use[i];
+    pipeline->slot_of_node[i] = slot;
+  }
+}
+
+// Reads the frame (same as ccv_read) and runs every node. Returns a js array with one entry per requested output: a
+// ccv_dense_matrix_t or, for ccv_mser nodes, a {keypoints, labels} object.
+// The returned matrices are reused by the next run, deleting them only drops the reference.
+val ccvjs_pipeline_run(const std::shared_ptr<ccv_pipeline_t>& pipeline, val source, int type) {
+  ccv_dense_matrix_t* input_ptr = nullptr;
+  ccv_read_html(source, &input_ptr, type);
+  auto input = make_shared_with_delete(input_ptr);
+
+  int n = pipeline->nodes.size();
+  int input_type = CCV_GET_DATA_TYPE(input->type) | CCV_GET_CHANNEL(input->type);
+  bool planned = (
+    pipeline->planned_rows == input->rows &&
+    pipeline->planned_cols == input->cols &&
+    pipeline->planned_type == input_type
+  );
+
+  std::vector<int> last_use = ccv_pipeline_last_use(pipeline.get());
+  std::vector<std::shared_ptr<ccv_dense_matrix_t>> matrices(n);
+  std::vector<std::shared_ptr<CCVArray<ccv_mser_keypoint_t>>> keypoints(n);
+  matrices[0] = input;
+  for (int i = 1; i < n; i++) {
+    const ccv_pipeline_t::node_t& node = pipeline->nodes[i];
+    bool in_place = ccv_pipeline_in_place(pipeline.get(), last_use, i);
+    ccv_dense_matrix_t* a = matrices[node.a].get();
+    ccv_dense_matrix_t* b = (planned && !in_place) ? pipeline->slots[pipeline->slot_of_node[i]].get() : nullptr;
+    switch (node.op) {
+      case ccv_pipeline_t::SAMPLE_DOWN:
+        ccv_sample_down(a, &b, node.type, node.src_x, node.src_y);
+        break;
+      case ccv_pipeline_t::BLUR:
+        ccv_blur(a, &b, node.type, node.sigma);
+        break;
+      case ccv_pipeline_t::CANNY:
+        ccv_canny(a, &b, node.type, node.size, node.low_thresh, node.high_thresh);
+        break;
+      case ccv_pipeline_t::CLOSE_OUTLINE:
+        ccv_close_outline(a, &b, node.type);
+        break;
+      case ccv_pipeline_t::FLIP:
+        if (in_place) {
+          ccv_flip(a, 0, 0, node.flip);
+          b = a;
+        } else {
+          ccv_flip(a, &b, node.type, node.flip);
+        }
+        break;
+      case ccv_pipeline_t::MSER: {
+        ccv_dense_matrix_t* h = node.h >= 0 ? matrices[node.h].get() : nullptr;
+        keypoints[i] = make_shared_with_delete((CCVArray<ccv_mser_keypoint_t>*)ccv_mser(a, h, &b, node.type, node.mser_params));
+        break;
+      }
+      default:
+        assert(false);
+    }
+    if (in_place) {
+      matrices[i] = matrices[node.a];
+    } else if (planned) {
+      // ccv only allocates a new output matrix when given a null one
+      assert(b == pipeline->slots[pipeline->slot_of_node[i]].get());
+      matrices[i] = pipeline->slots[pipeline->slot_of_node[i]];
+    } else {
+      matrices[i] = make_shared_with_delete(b);
+    }
+  }
+
+  if (!planned) {
+    ccv_pipeline_plan(pipeline.get(), matrices);
+    pipeline->planned_rows = input->rows;
+    pipeline->planned_cols = input->cols;
+    pipeline->planned_type = input_type;
+  }
+
+  val results = val::array();
+  for (int i : pipeline->outputs) {
+    if (pipeline->nodes[i].op == ccv_pipeline_t::MSER) {
+      val result = val::object();
+      result.set("keypoints", keypoints[i]);
+      result.set("labels", matrices[i]);
+      results.call<void>("push", result);
+    } else {
+      results.call<void>("push", matrices[i]);
+    }
+  }
+  return results;
 }
+val ccvjs_pipeline_run(const std::shared_ptr<ccv_pipeline_t>& pipeline, val source) {
+  return ccvjs_pipeline_run(pipeline, source, CCV_IO_GRAY);
+}
+
 
-template<typename T, std::size_t... I>
-void register_array_elements(T& a, std::index_sequence<I...>) {
-  (a.element(index<I>()), ...);
+// Compares each frame with the last one that had changes on a grid of tiles so a detector only has to run when (and
+// where) something moved. Module.motionGated in ccv_pre.js uses it to skip frames and hand back the cached results.
+typedef struct {
+  int tile_size; // Width and height of a tile in pixels of the frame
+  int downsample; // Number of times the frame is halved with ccv_sample_down before comparing
+  int pixel_threshold; // A pixel changed if any of its channels moved by more than this
+  double tile_threshold; // A tile changed if more than this fraction of its pixels changed
+} ccv_motion_gate_param_t;
+
+const ccv_motion_gate_param_t ccv_motion_gate_default_params = {
+  .tile_size = 32,
+  .downsample = 2,
+  .pixel_threshold = 24,
+  .tile_threshold = 0.02,
+};
+
+typedef struct {
+  int frames;
+  int skipped_frames; // Frames where no tile changed
+  int tiles;
+  int unchanged_tiles; // Tiles that didn't change, whether or not the consumer only processed the changed ones
+} ccv_motion_gate_stats_t;
+
+struct ccv_motion_gate_t {
+  // Downsampled copy of the last frame that had changes. Only replacing it then means slow changes add up until they
+  // cross the thresholds instead of slipping through one frame at a time.
+  std::shared_ptr<ccv_dense_matrix_t> reference;
+  int reference_rows = -1; // Size of the frame before downsampling
+  int reference_cols = -1;
+  std::vector<ccv_rect_t> changed_tiles;
+  ccv_motion_gate_stats_t stats = {};
+};
+
+val ccv_motion_gate_t_get_changed_tiles(const std::shared_ptr<ccv_motion_gate_t>& gate) {
+  val tiles = val::array();
+  for (const ccv_rect_t& tile : gate->changed_tiles) {
+    tiles.call<void>("push", val(tile));
+  }
+  return tiles;
+}
+ccv_motion_gate_stats_t ccv_motion_gate_t_get_stats(const std::shared_ptr<ccv_motion_gate_t>& gate) {
+  return gate->stats;
+}
+void ccv_motion_gate_t_reset(const std::shared_ptr<ccv_motion_gate_t>& gate) {
+  *gate = ccv_motion_gate_t();
 }
-template<typename T, size_t N>
-void register_array(const char* name) {
-  value_array<std::array<T, N>> temp(name);
-  register_array_elements(temp, std::make_index_sequence<N>());
+
+// Always returns a new matrix, the caller's frame gets overwritten by the next ccv_read
+ccv_dense_matrix_t* ccv_motion_gate_downsample(ccv_dense_matrix_t* a, int times) {
+  if (times == 0) {
+    ccv_dense_matrix_t* b = ccv_dense_matrix_new(a->rows, a->cols, CCV_GET_DATA_TYPE(a->type) | CCV_GET_CHANNEL(a->type), 0, 0);
+    memcpy(b->data.u8, a->data.u8, a->rows * a->step);
+    return b;
+  }
+  ccv_dense_matrix_t* b = nullptr;
+  ccv_sample_down(a, &b, 0, 0, 0);
+  for (int i = 1; i < times && b->rows > 1 && b->cols > 1; i++) {
+    ccv_dense_matrix_t* c = nullptr;
+    ccv_sample_down(b, &c, 0, 0, 0);
+    ccv_matrix_free(b);
+    b = c;
+  }
+  return b;
+}
+
+// Whether enough pixels of the tile (in frame coordinates) differ between the two downsampled matrices
+bool ccv_motion_gate_tile_changed(ccv_dense_matrix_t* a, ccv_dense_matrix_t* b, int rows, int cols, ccv_rect_t tile, ccv_motion_gate_param_t params) {
+  // Keep at least one pixel so tiles smaller than the downsampling still get compared
+  int x0 = ccv_min(tile.x * a->cols / cols, a->cols - 1);
+  int y0 = ccv_min(tile.y * a->rows / rows, a->rows - 1);
+  int x1 = ccv_max((tile.x + tile.width) * a->cols / cols, x0 + 1);
+  int y1 = ccv_max((tile.y + tile.height) * a->rows / rows, y0 + 1);
+  int c = CCV_GET_CHANNEL(a->type);
+  int changed = 0;
+  for (int y = y0; y < y1; y++) {
+    const unsigned char* a_row = a->data.u8 + y * a->step;
+    const unsigned char* b_row = b->data.u8 + y * b->step;
+    for (int x = x0 * c; x < x1 * c; x += c) {
+      for (int k = 0; k < c; k++) {
+        if (abs(a_row[x + k] - b_row[x + k]) > params.pixel_threshold) {
+          changed++;
+          break;
+        }
+      }
+    }
+  }
+  return changed > params.tile_threshold * (x1 - x0) * (y1 - y0);
+}
+
+// Compares the frame with the reference and returns the number of changed tiles (every tile for the first frame or
+// after the frame size changes). 0 means detection can be skipped. The changed tiles are available from
+// gate.changed_tiles() until the next update.
+int ccvjs_motion_gate_update(const std::shared_ptr<ccv_motion_gate_t>& gate, const std::shared_ptr<ccv_dense_matrix_t>& a, ccv_motion_gate_param_t params = ccv_motion_gate_default_params) {
+  assert(CCV_GET_DATA_TYPE(a->type) == CCV_8U);
+  assert(params.tile_size > 0 && params.downsample >= 0);
+  auto current = make_shared_with_delete(ccv_motion_gate_downsample(a.get(), params.downsample));
+  bool comparable = (
+    gate->reference &&
+    gate->reference_rows == a->rows &&
+    gate->reference_cols == a->cols &&
+    gate->reference->rows == current->rows &&
+    gate->reference->cols == current->cols &&
+    CCV_GET_CHANNEL(gate->reference->type) == CCV_GET_CHANNEL(current->type)
+  );
+
+  gate->changed_tiles.clear();
+  int tiles = 0;
+  for (int y = 0; y < a->rows; y += params.tile_size) {
+    for (int x = 0; x < a->cols; x += params.tile_size) {
+      ccv_rect_t tile = ccv_rect(x, y, ccv_min(params.tile_size, a->cols - x), ccv_min(params.tile_size, a->rows - y));
+      tiles++;
+      if (!comparable || ccv_motion_gate_tile_changed(gate->reference.get(), current.get(), a->rows, a->cols, tile, params)) {
+        gate->changed_tiles.push_back(tile);
+      }
+    }
+  }
+
+  int changed = gate->changed_tiles.size();
+  gate->stats.frames++;
+  gate->stats.tiles += tiles;
+  gate->stats.unchanged_tiles += tiles - changed;
+  if (changed == 0) {
+    gate->stats.skipped_frames++;
+  } else {
+    gate->reference = current;
+    gate->reference_rows = a->rows;
+    gate->reference_cols = a->cols;
+  }
+  return changed;
 }
 
+
 EMSCRIPTEN_BINDINGS(ccv_js_module) {
   // TODO: These bindings were added by hand so there are a lot stuff missing. Should add a header parser to try to autogenerate them.
 
@@ -514,35 +606,26 @@ EMSCRIPTEN_BINDINGS(ccv_js_module) {
     .function("get_step", &ccv_dense_matrix_t_get_step)
     .function("get_type", &ccv_dense_matrix_t_get_type);
 
-#ifdef WITH_FILESYSTEM
-  class_<ccv_scd_classifier_cascade_t>("ccv_scd_classifier_cascade_t")
-    .smart_ptr_constructor("shared_ptr<ccv_scd_classifier_cascade_t>", &std::make_shared<ccv_scd_classifier_cascade_t>);
-  class_<ccv_icf_classifier_cascade_t>("ccv_icf_classifier_cascade_t")
-    .smart_ptr_constructor("shared_ptr<ccv_icf_classifier_cascade_t>", &std::make_shared<ccv_icf_classifier_cascade_t>);
-  class_<ccv_dpm_mixture_model_t>("ccv_dpm_mixture_model_t")
-    .smart_ptr_constructor("shared_ptr<ccv_dpm_mixture_model_t>", &std::make_shared<ccv_dpm_mixture_model_t>);
-#endif
-
-  class_<ccv_tld_t>("ccv_tld_t")
-    .smart_ptr_constructor("shared_ptr<ccv_tld_t>", &std::make_shared<ccv_tld_t>)
-    .function("top", &ccv_tld_t_get_top);
-  class_<ccv_tld_info_t>("ccv_tld_info_t")
-    .smart_ptr_constructor("shared_ptr<ccv_tld_info_t>", &std::make_shared<ccv_tld_info_t>)
-    .property("perform_track", &ccv_tld_info_t::perform_track)
-    .property("perform_learn", &ccv_tld_info_t::perform_learn)
-    .property("track_success", &ccv_tld_info_t::track_success)
-    .property("ferns_detects", &ccv_tld_info_t::ferns_detects)
-    .property("nnc_detects", &ccv_tld_info_t::nnc_detects)
-    .property("clustered_detects", &ccv_tld_info_t::clustered_detects)
-    .property("confident_matches", &ccv_tld_info_t::confident_matches)
-    .property("close_matches", &ccv_tld_info_t::close_matches);
+  class_<ccv_pipeline_t>("ccv_pipeline_t")
+    .smart_ptr_constructor("shared_ptr<ccv_pipeline_t>", &std::make_shared<ccv_pipeline_t>)
+    .function("sample_down", &ccv_pipeline_t_sample_down)
+    .function("blur", &ccv_pipeline_t_blur)
+    .function("canny", &ccv_pipeline_t_canny)
+    .function("close_outline", &ccv_pipeline_t_close_outline)
+    .function("flip", &ccv_pipeline_t_flip)
+    .function("mser", &ccv_pipeline_t_mser)
+    .function("output", &ccv_pipeline_t_output);
+
+  class_<ccv_motion_gate_t>("ccv_motion_gate_t")
+    .smart_ptr_constructor("shared_ptr<ccv_motion_gate_t>", &std::make_shared<ccv_motion_gate_t>)
+    .function("changed_tiles", &ccv_motion_gate_t_get_changed_tiles)
+    .function("stats", &ccv_motion_gate_t_get_stats)
+    .function("reset", &ccv_motion_gate_t_reset);
 
   class_<ccv_array_t>("ccv_array_t");
   register_ccv_array<ccv_rect_t>("ccv_rect_array");
   register_ccv_array<ccv_comp_t>("ccv_comp_array");
   register_ccv_array<ccv_keypoint_t>("ccv_keypoint_array");
-  register_ccv_array<ccv_root_comp_t>("ccv_root_comp_array");
-  register_ccv_array<ccv_mser_keypoint_t>("ccv_mser_keypoint_array");
   register_ccv_array<ccv_decimal_point_t>("ccv_decimal_point_array");
   register_ccv_array<ccv_decimal_point_with_status_t>("ccv_decimal_point_with_status_array");
 
@@ -550,21 +633,6 @@ EMSCRIPTEN_BINDINGS(ccv_js_module) {
   function("ccv_read", select_overload<int(val, std::shared_ptr<ccv_dense_matrix_t>&, int)>(&ccvjs_read));
   function("ccv_read", select_overload<int(val, std::shared_ptr<ccv_dense_matrix_t>&)>(&ccvjs_read));
   function("ccv_write", &ccvjs_write);
-  function("ccv_tld_new", &ccvjs_tld_new);
-  function("ccv_tld_track_object", &ccvjs_tld_track_object);
-  function("ccv_swt_detect_words", &ccvjs_swt_detect_words);
-  function("ccv_sift", &ccvjs_sift);
-  function("ccv_sift_match", &ccvjs_sift_match);
-#ifdef WITH_FILESYSTEM
-  function("ccv_scd_classifier_cascade_read", &ccvjs_scd_classifier_cascade_read);
-  function("ccv_scd_detect_objects", &ccvjs_scd_detect_objects);
-  function("ccv_icf_read_classifier_cascade", &ccvjs_icf_read_classifier_cascade);
-  function("ccv_icf_detect_objects", &ccvjs_icf_detect_objects);
-  function("ccv_dpm_read_mixture_model", &ccvjs_dpm_read_mixture_model);
-  // TODO: Allow taking more than one model
-  function("ccv_dpm_detect_objects", &ccvjs_dpm_detect_objects);
-#endif
-  function("ccv_mser", &ccvjs_mser);
   function("ccv_canny", &ccvjs_canny);
   function("ccv_close_outline", &ccvjs_close_outline);
   function("ccv_flip", &ccvjs_flip);
@@ -573,22 +641,12 @@ EMSCRIPTEN_BINDINGS(ccv_js_module) {
   function("ccv_sample_down", &ccvjs_sample_down);
   function("ccv_optical_flow_lucas_kanade", select_overload<void(const std::shared_ptr<ccv_dense_matrix_t>&, const std::shared_ptr<ccv_dense_matrix_t>&, const std::shared_ptr<CCVArray<ccv_decimal_point_t>>&, std::shared_ptr<CCVArray<ccv_decimal_point_with_status_t>>&, ccv_size_t, int, double)>(&ccvjs_optical_flow_lucas_kanade));
   function("ccv_optical_flow_lucas_kanade", select_overload<void(const std::shared_ptr<ccv_dense_matrix_t>&, const std::shared_ptr<ccv_dense_matrix_t>&, const std::shared_ptr<CCVArray<ccv_decimal_point_t>>&, std::shared_ptr<CCVArray<ccv_decimal_point_with_status_t>>&, ccv_lucas_kanade_param_t)>(&ccvjs_optical_flow_lucas_kanade));
+  function("ccv_pipeline_run", select_overload<val(const std::shared_ptr<ccv_pipeline_t>&, val, int)>(&ccvjs_pipeline_run));
+  function("ccv_pipeline_run", select_overload<val(const std::shared_ptr<ccv_pipeline_t>&, val)>(&ccvjs_pipeline_run));
+  function("ccv_motion_gate_update", &ccvjs_motion_gate_update);
 
-
-#ifdef WITH_FILESYSTEM
-  // Location of the trained models in the emscripten filesystem.
-  // For example the build flag "--embed-file external/ccv/samples/face.sqlite3@/" will put face.sqlite3 in "/" of the emscripten filesystem.
-  // TODO: Shouldn't use embed-file. Should load the file into emscripten filesystem over network instead.
-  // TODO: The sqlite file for convnet is huge so it is probably infeasible to add.
-  std::string CCV_SCD_FACE_FILE = "/face.sqlite3";
-  std::string CCV_ICF_PEDESTRIAN_FILE = "/pedestrian.icf";
-  std::string CCV_DPM_PEDESTRIAN_FILE = "/pedestrian.m";
-  std::string CCV_DPM_CAR_FILE = "/car.m";
-  constant("CCV_SCD_FACE_FILE", CCV_SCD_FACE_FILE);
-  constant("CCV_ICF_PEDESTRIAN_FILE", CCV_ICF_PEDESTRIAN_FILE);
-  constant("CCV_DPM_PEDESTRIAN_FILE", CCV_DPM_PEDESTRIAN_FILE);
-  constant("CCV_DPM_CAR_FILE", CCV_DPM_CAR_FILE);
-#endif
+  // Not a ccv function so it isn't prefixed with ccv_ (see Module.installScopeTracking in ccv_pre.js)
+  function("getLiveAllocationCount", &get_live_allocation_count);
 
 
 
@@ -607,20 +665,11 @@ EMSCRIPTEN_BINDINGS(ccv_js_module) {
   constant("CCV_FLIP_Y", (int)CCV_FLIP_Y);
   constant("CCV_DARK_TO_BRIGHT", (int)CCV_DARK_TO_BRIGHT);
   constant("CCV_BRIGHT_TO_DARK", (int)CCV_BRIGHT_TO_DARK);
-  constant("CCV_DPM_NO_NESTED", (int)CCV_DPM_NO_NESTED);
 
 
 
-  constant("ccv_tld_default_params", ccv_tld_default_params);
-  constant("ccv_swt_default_params", ccv_swt_default_params);
-  constant("ccv_sift_default_params", ccv_sift_default_params);
-#ifdef WITH_FILESYSTEM
-  constant("ccv_scd_default_params", ccv_scd_default_params);
-  constant("ccv_icf_default_params", ccv_icf_default_params);
-  constant("ccv_dpm_default_params", ccv_dpm_default_params);
-#endif
-  constant("ccv_mser_default_params", ccv_mser_default_params);
   constant("ccv_lucas_kanade_default_params", ccv_lucas_kanade_default_params);
+  constant("ccv_motion_gate_default_params", ccv_motion_gate_default_params);
 
 
 
@@ -647,62 +696,6 @@ EMSCRIPTEN_BINDINGS(ccv_js_module) {
     .field("neighbors", &ccv_comp_t::neighbors)
     .field("classification", &ccv_comp_t::classification);
 
-  value_object<ccv_tld_param_t>("ccv_tld_param_t")
-    .field("win_size", &ccv_tld_param_t::win_size)
-    .field("level", &ccv_tld_param_t::level)
-    .field("min_forward_backward_error", &ccv_tld_param_t::min_forward_backward_error)
-    .field("min_eigen", &ccv_tld_param_t::min_eigen)
-    .field("min_win", &ccv_tld_param_t::min_win)
-    .field("interval", &ccv_tld_param_t::interval)
-    .field("shift", &ccv_tld_param_t::shift)
-    .field("top_n", &ccv_tld_param_t::top_n)
-    .field("rotation", &ccv_tld_param_t::rotation)
-    .field("include_overlap", &ccv_tld_param_t::include_overlap)
-    .field("exclude_overlap", &ccv_tld_param_t::exclude_overlap)
-    .field("structs", &ccv_tld_param_t::structs)
-    .field("features", &ccv_tld_param_t::features)
-    .field("validate_set", &ccv_tld_param_t::validate_set)
-    .field("nnc_same", &ccv_tld_param_t::nnc_same)
-    .field("nnc_thres", &ccv_tld_param_t::nnc_thres)
-    .field("nnc_verify", &ccv_tld_param_t::nnc_verify)
-    .field("nnc_beyond", &ccv_tld_param_t::nnc_beyond)
-    .field("nnc_collect", &ccv_tld_param_t::nnc_collect)
-    .field("bad_patches", &ccv_tld_param_t::bad_patches)
-    .field("new_deform", &ccv_tld_param_t::new_deform)
-    .field("track_deform", &ccv_tld_param_t::track_deform)
-    .field("new_deform_angle", &ccv_tld_param_t::new_deform_angle)
-    .field("track_deform_angle", &ccv_tld_param_t::track_deform_angle)
-    .field("new_deform_scale", &ccv_tld_param_t::new_deform_scale)
-    .field("track_deform_scale", &ccv_tld_param_t::track_deform_scale)
-    .field("new_deform_shift", &ccv_tld_param_t::new_deform_shift)
-    .field("track_deform_shift", &ccv_tld_param_t::track_deform_shift);
-
-  register_array<double, 2>("array_double_2"); // For ccv_swt_param_t::same_word_thresh
-  value_object<ccv_swt_param_t>("ccv_swt_param_t")
-    .field("interval", &ccv_swt_param_t::interval)
-    .field("min_neighbors", &ccv_swt_param_t::min_neighbors)
-    .field("scale_invariant", &ccv_swt_param_t::scale_invariant)
-    .field("direction", &ccv_swt_param_t::direction)
-    .field("same_word_thresh", reinterpret_cast<std::array<double, 2> ccv_swt_param_t::*>(&ccv_swt_param_t::same_word_thresh)) // Emscripten doesn't like the type double[2], https://github.com/kripken/emscripten/pull/4510
-    .field("size", &ccv_swt_param_t::size)
-    .field("low_thresh", &ccv_swt_param_t::low_thresh)
-    .field("high_thresh", &ccv_swt_param_t::high_thresh)
-    .field("max_height", &ccv_swt_param_t::max_height)
-    .field("min_height", &ccv_swt_param_t::min_height)
-    .field("min_area", &ccv_swt_param_t::min_area)
-    .field("letter_occlude_thresh", &ccv_swt_param_t::letter_occlude_thresh)
-    .field("aspect_ratio", &ccv_swt_param_t::aspect_ratio)
-    .field("std_ratio", &ccv_swt_param_t::std_ratio)
-    .field("thickness_ratio", &ccv_swt_param_t::thickness_ratio)
-    .field("height_ratio", &ccv_swt_param_t::height_ratio)
-    .field("intensity_thresh", &ccv_swt_param_t::intensity_thresh)
-    .field("distance_ratio", &ccv_swt_param_t::distance_ratio)
-    .field("intersect_ratio", &ccv_swt_param_t::intersect_ratio)
-    .field("elongate_ratio", &ccv_swt_param_t::elongate_ratio)
-    .field("letter_thresh", &ccv_swt_param_t::letter_thresh)
-    .field("breakdown", &ccv_swt_param_t::breakdown)
-    .field("breakdown_ratio", &ccv_swt_param_t::breakdown_ratio);
-
 
 
   /* TODO: Not sure how to handle unions
@@ -722,66 +715,6 @@ EMSCRIPTEN_BINDINGS(ccv_js_module) {
       .field("level", &ccv_keypoint_t::level)
       //.field("affine", &ccv_keypoint_t::affine)
       .field("regular", &ccv_keypoint_t::regular);
-  value_object<ccv_sift_param_t>("ccv_sift_param_t")
-    .field("up2x", &ccv_sift_param_t::up2x)
-    .field("noctaves", &ccv_sift_param_t::noctaves)
-    .field("nlevels", &ccv_sift_param_t::nlevels)
-    .field("edge_threshold", &ccv_sift_param_t::edge_threshold)
-    .field("peak_threshold", &ccv_sift_param_t::peak_threshold)
-    .field("norm_threshold", &ccv_sift_param_t::norm_threshold);
-
-
-
-#ifdef WITH_FILESYSTEM
-  value_object<ccv_scd_param_t>("ccv_scd_param_t")
-    .field("min_neighbors", &ccv_scd_param_t::min_neighbors)
-    .field("step_through", &ccv_scd_param_t::step_through)
-    .field("interval", &ccv_scd_param_t::interval)
-    .field("size", &ccv_scd_param_t::size);
-
-  value_object<ccv_icf_param_t>("ccv_icf_param_t")
-    .field("min_neighbors", &ccv_icf_param_t::min_neighbors)
-    .field("flags", &ccv_icf_param_t::flags)
-    .field("step_through", &ccv_icf_param_t::step_through)
-    .field("interval", &ccv_icf_param_t::interval)
-    .field("threshold", &ccv_icf_param_t::threshold);
-
-  register_array<ccv_comp_t, CCV_DPM_PART_MAX>("comp_array"); // For ccv_root_comp_t::part
-  value_object<ccv_root_comp_t>("ccv_root_comp_t")
-    .field("rect", &ccv_root_comp_t::rect)
-    .field("neighbors", &ccv_root_comp_t::neighbors)
-    .field("classification", &ccv_root_comp_t::classification)
-    .field("pnum", &ccv_root_comp_t::pnum)
-    .field("part", reinterpret_cast<std::array<ccv_comp_t, CCV_DPM_PART_MAX> ccv_root_comp_t::*>(&ccv_root_comp_t::part));
-  value_object<ccv_dpm_param_t>("ccv_dpm_param_t")
-    .field("interval", &ccv_dpm_param_t::interval)
-    .field("min_neighbors", &ccv_dpm_param_t::min_neighbors)
-    .field("flags", &ccv_dpm_param_t::flags)
-    .field("threshold", &ccv_dpm_param_t::threshold);
-#endif
-
-
-
-  value_object<ccv_mser_param_t>("ccv_mser_param_t")
-    .field("min_area", &ccv_mser_param_t::min_area)
-    .field("max_area", &ccv_mser_param_t::max_area)
-    .field("min_diversity", &ccv_mser_param_t::min_diversity)
-    .field("area_threshold", &ccv_mser_param_t::area_threshold)
-    .field("min_margin", &ccv_mser_param_t::min_margin)
-    .field("max_evolution", &ccv_mser_param_t::max_evolution)
-    .field("edge_blur_sigma", &ccv_mser_param_t::edge_blur_sigma)
-    .field("delta", &ccv_mser_param_t::delta)
-    .field("max_variance", &ccv_mser_param_t::max_variance)
-    .field("direction", &ccv_mser_param_t::direction);
-  value_object<ccv_mser_keypoint_t>("ccv_mser_keypoint_t")
-    .field("keypoint", &ccv_mser_keypoint_t::keypoint)
-    .field("m01", &ccv_mser_keypoint_t::m01)
-    .field("m02", &ccv_mser_keypoint_t::m02)
-    .field("m10", &ccv_mser_keypoint_t::m10)
-    .field("m11", &ccv_mser_keypoint_t::m11)
-    .field("m20", &ccv_mser_keypoint_t::m20)
-    .field("rect", &ccv_mser_keypoint_t::rect)
-    .field("size", &ccv_mser_keypoint_t::size);
 
 
 
@@ -795,4 +728,14 @@ EMSCRIPTEN_BINDINGS(ccv_js_module) {
   value_object<ccv_decimal_point_with_status_t>("ccv_decimal_point_with_status_t")
     .field("point", &ccv_decimal_point_with_status_t::point)
     .field("status", &ccv_decimal_point_with_status_t::status);
+  value_object<ccv_motion_gate_param_t>("ccv_motion_gate_param_t")
+    .field("tile_size", &ccv_motion_gate_param_t::tile_size)
+    .field("downsample", &ccv_motion_gate_param_t::downsample)
+    .field("pixel_threshold", &ccv_motion_gate_param_t::pixel_threshold)
+    .field("tile_threshold", &ccv_motion_gate_param_t::tile_threshold);
+  value_object<ccv_motion_gate_stats_t>("ccv_motion_gate_stats_t")
+    .field("frames", &ccv_motion_gate_stats_t::frames)
+    .field("skipped_frames", &ccv_motion_gate_stats_t::skipped_frames)
+    .field("tiles", &ccv_motion_gate_stats_t::tiles)
+    .field("unchanged_tiles", &ccv_motion_gate_stats_t::unchanged_tiles);
 }
@@ -0,0 +1,150 @@
+// Helpers shared by the core bindings (ccv_bindings.cpp) and the detector bindings (ccv_bindings_*.cpp).
+// Types that more than one detector uses are registered with embind by the core since embind doesn't allow registering
+// a type twice.
+#ifndef CCV_BINDINGS_H
+#define CCV_BINDINGS_H
+
+#include <emscripten.h>
+#include <emscripten/bind.h>
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <ccv.h>
+#include <ccv_internal.h>
+}
+
+using namespace emscripten;
+
+
+// Wrap ccv_array_t with type information
+template<typename T>
+struct CCVArray : public ccv_array_t {
+  static std::shared_ptr<CCVArray<T>> fromJS(val jsArray) {
+    int length = jsArray["length"].as<int>();
+    auto array = make_shared_with_delete((CCVArray<T>*)ccv_array_new(sizeof(T), length, 0));
+    for (int i = 0; i < length; i++) {
+      T temp = jsArray[i].as<T>();
+      ccv_array_push(array.get(), &temp);
+    }
+    return array;
+  }
+
+  void push(const T& x) {
+    ccv_array_push(this, &x);
+  }
+
+  const T& get(int i) const {
+    return *(T*)ccv_array_get(this, i);
+  }
+
+  val toJS() const {
+    val jsArray = val::array();
+    for (int i = 0; i < this->rnum; i++) {
+      jsArray.call<void>("push", val(*(T*)ccv_array_get(this, i)));
+    }
+    return jsArray;
+  }
+};
+
+
+// Deleters. Detector specific ones live with their detector's bindings.
+template<typename T>
+struct Deleter { // Default deleter, probably only used by ccv_tld_info_t and the structs defined by the bindings
+  void operator()(T* ptr) {
+    //printf("%p %s default freed\n", ptr, typeid(T).name());
+    delete ptr;
+  }
+};
+template<>
+struct Deleter<ccv_dense_matrix_t> {
+  void operator()(ccv_dense_matrix_t* ptr) {
+    //printf("%p %s freed\n", ptr, typeid(ccv_dense_matrix_t).name());
+    ccv_matrix_free(ptr);
+  }
+};
+template<typename T>
+struct Deleter<CCVArray<T>> {
+  void operator()(CCVArray<T>* ptr) {
+    //printf("%p %s freed\n", ptr, typeid(CCVArray<T>).name());
+    ccv_array_free(ptr);
+  }
+};
+
+
+// Number of pointers handed out by make_shared_with_delete that haven't been freed yet. Used for leak reporting.
+extern int live_allocation_count;
+
+// Takes ownership of a raw pointer and adds the correct deleter for that type
+template<typename T>
+auto make_shared_with_delete(T* ptr) {
+  //printf("%p %s alloced\n", ptr, typeid(T).name());
+  if (ptr) {
+    live_allocation_count++;
+  }
+  return std::shared_ptr<T>(ptr, [](T* ptr) {
+    if (ptr) {
+      live_allocation_count--;
+    }
+    Deleter<T>()(ptr);
+  });
+};
+
+
+template<typename T>
+std::vector<T*> vectorFromJS(val jsArray) {
+  assert(val::global("Array").call<bool>("isArray", jsArray));
+  int length = jsArray["length"].as<int>();
+  std::vector<T*> vec;
+  for (int i = 0; i < length; i++) {
+    vec.push_back(jsArray[i].as<std::shared_ptr<T>>().get());
+  }
+  return vec;
+}
+
+
+template<typename T>
+void CCVArray_push(const std::shared_ptr<CCVArray<T>>& ptr, const T& x) {
+  ptr->push(x);
+}
+template<typename T>
+const T& CCVArray_get(const std::shared_ptr<CCVArray<T>>& ptr, int i) {
+  return ptr->get(i);
+}
+template<typename T>
+int CCVArray_get_rnum(const std::shared_ptr<CCVArray<T>>& ptr) {
+  return ptr->rnum;
+}
+template<typename T>
+val CCVArray_toJS(const std::shared_ptr<CCVArray<T>>& ptr) {
+  return ptr->toJS();
+}
+
+template<typename T>
+void register_ccv_array(const char* name) {
+  class_<CCVArray<T>, base<ccv_array_t>>(name)
+    .smart_ptr_constructor("shared_ptr<ccv_array_t>", &std::make_shared<CCVArray<T>>)
+    .class_function("fromJS", &CCVArray<T>::fromJS)
+    // TODO: Should bind directly to the member functions of CCVArray<T> but doing so seems to hit a bug
+    // where it will keep using the stale pointer in the shared_ptr even after being changed.
+    // Wrapping the functions seems to avoid the problem.
+    // https://github.com/kripken/emscripten/issues/4583
+    .function("getLength", &CCVArray_get_rnum<T>)
+    .function("get", &CCVArray_get<T>)
+    .function("push", &CCVArray_push<T>)
+    .function("toJS", &CCVArray_toJS<T>);
+}
+
+template<typename T, std::size_t... I>
+void register_array_elements(T& a, std::index_sequence<I...>) {
+  (a.element(index<I>()), ...);
+}
+template<typename T, size_t N>
+void register_array(const char* name) {
+  value_array<std::array<T, N>> temp(name);
+  register_array_elements(temp, std::make_index_sequence<N>());
+}
+
+#endif // CCV_BINDINGS_H
@@ -0,0 +1,61 @@
+#include "ccv_bindings.h"
+
+// DPM: Deformable Parts Model
+
+#ifdef WITH_FILESYSTEM
+
+template<>
+struct Deleter<ccv_dpm_mixture_model_t> {
+  void operator()(ccv_dpm_mixture_model_t* ptr) {
+    //printf("%p %s freed\n", ptr, typeid(ccv_dpm_mixture_model_t).name());
+    ccv_dpm_mixture_model_free(ptr);
+  }
+};
+
+
+// ccv_dpm_mixture_model_t* ccv_dpm_read_mixture_model(const char* directory);
+std::shared_ptr<ccv_dpm_mixture_model_t> ccvjs_dpm_read_mixture_model(std::string directory) {
+  return make_shared_with_delete(ccv_dpm_read_mixture_model(directory.c_str()));
+}
+
+// ccv_array_t* ccv_dpm_detect_objects(ccv_dense_matrix_t* a, ccv_dpm_mixture_model_t** model, int count, ccv_dpm_param_t params);
+std::shared_ptr<CCVArray<ccv_root_comp_t>> ccvjs_dpm_detect_objects(const std::shared_ptr<ccv_dense_matrix_t>& a, val modelJSArray, int count, ccv_dpm_param_t params = ccv_dpm_default_params) {
+  auto vec = vectorFromJS<ccv_dpm_mixture_model_t>(modelJSArray);
+  return make_shared_with_delete((CCVArray<ccv_root_comp_t>*)ccv_dpm_detect_objects(a.get(), vec.data(), vec.size(), params));
+}
+
+
+EMSCRIPTEN_BINDINGS(ccv_js_dpm_module) {
+  class_<ccv_dpm_mixture_model_t>("ccv_dpm_mixture_model_t")
+    .smart_ptr_constructor("shared_ptr<ccv_dpm_mixture_model_t>", &std::make_shared<ccv_dpm_mixture_model_t>);
+
+  register_ccv_array<ccv_root_comp_t>("ccv_root_comp_array");
+
+  // TODO: Allow taking more than one model
+  function("ccv_dpm_read_mixture_model", &ccvjs_dpm_read_mixture_model);
+  function("ccv_dpm_detect_objects", &ccvjs_dpm_detect_objects);
+
+  // Location of the trained models in the emscripten filesystem. The build embeds them there.
+  std::string CCV_DPM_PEDESTRIAN_FILE = "/pedestrian.m";
+  std::string CCV_DPM_CAR_FILE = "/car.m";
+  constant("CCV_DPM_PEDESTRIAN_FILE", CCV_DPM_PEDESTRIAN_FILE);
+  constant("CCV_DPM_CAR_FILE", CCV_DPM_CAR_FILE);
+
+  constant("CCV_DPM_NO_NESTED", (int)CCV_DPM_NO_NESTED);
+  constant("ccv_dpm_default_params", ccv_dpm_default_params);
+
+  register_array<ccv_comp_t, CCV_DPM_PART_MAX>("comp_array"); // For ccv_root_comp_t::part
+  value_object<ccv_root_comp_t>("ccv_root_comp_t")
+    .field("rect", &ccv_root_comp_t::rect)
+    .field("neighbors", &ccv_root_comp_t::neighbors)
+    .field("classification", &ccv_root_comp_t::classification)
+    .field("pnum", &ccv_root_comp_t::pnum)
+    .field("part", reinterpret_cast<std::array<ccv_comp_t, CCV_DPM_PART_MAX> ccv_root_comp_t::*>(&ccv_root_comp_t::part));
+  value_object<ccv_dpm_param_t>("ccv_dpm_param_t")
+    .field("interval", &ccv_dpm_param_t::interval)
+    .field("min_neighbors", &ccv_dpm_param_t::min_neighbors)
+    .field("flags", &ccv_dpm_param_t::flags)
+    .field("threshold", &ccv_dpm_param_t::threshold);
+}
+
+#endif // WITH_FILESYSTEM
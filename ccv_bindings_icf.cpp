@@ -0,0 +1,49 @@
+#include "ccv_bindings.h"
+
+// ICF: Integral Channel Features
+
+#ifdef WITH_FILESYSTEM
+
+template<>
+struct Deleter<ccv_icf_classifier_cascade_t> {
+  void operator()(ccv_icf_classifier_cascade_t* ptr) {
+    //printf("%p %s freed\n", ptr, typeid(ccv_icf_classifier_cascade_t).name());
+    ccv_icf_classifier_cascade_free(ptr);
+  }
+};
+
+
+// ccv_icf_classifier_cascade_t* ccv_icf_read_classifier_cascade(const char* filename);
+std::shared_ptr<ccv_icf_classifier_cascade_t> ccvjs_icf_read_classifier_cascade(const std::string& filename) {
+  return make_shared_with_delete(ccv_icf_read_classifier_cascade(filename.c_str()));
+}
+
+// ccv_array_t* ccv_icf_detect_objects(ccv_dense_matrix_t* a, void* cascade, int count, ccv_icf_param_t params);
+std::shared_ptr<CCVArray<ccv_comp_t>> ccvjs_icf_detect_objects(const std::shared_ptr<ccv_dense_matrix_t>& a, val cascadeJSArray, int count, ccv_icf_param_t params = ccv_icf_default_params) {
+  auto vec = vectorFromJS<ccv_icf_classifier_cascade_t>(cascadeJSArray);
+  return make_shared_with_delete((CCVArray<ccv_comp_t>*)ccv_icf_detect_objects(a.get(), vec.data(), vec.size(), params));
+}
+
+
+EMSCRIPTEN_BINDINGS(ccv_js_icf_module) {
+  class_<ccv_icf_classifier_cascade_t>("ccv_icf_classifier_cascade_t")
+    .smart_ptr_constructor("shared_ptr<ccv_icf_classifier_cascade_t>", &std::make_shared<ccv_icf_classifier_cascade_t>);
+
+  function("ccv_icf_read_classifier_cascade", &ccvjs_icf_read_classifier_cascade);
+  function("ccv_icf_detect_objects", &ccvjs_icf_detect_objects);
+
+  // Location of the trained model in the emscripten filesystem. The build embeds it there.
+  std::string CCV_ICF_PEDESTRIAN_FILE = "/pedestrian.icf";
+  constant("CCV_ICF_PEDESTRIAN_FILE", CCV_ICF_PEDESTRIAN_FILE);
+
+  constant("ccv_icf_default_params", ccv_icf_default_params);
+
+  value_object<ccv_icf_param_t>("ccv_icf_param_t")
+    .field("min_neighbors", &ccv_icf_param_t::min_neighbors)
+    .field("flags", &ccv_icf_param_t::flags)
+    .field("step_through", &ccv_icf_param_t::step_through)
+    .field("interval", &ccv_icf_param_t::interval)
+    .field("threshold", &ccv_icf_param_t::threshold);
+}
+
+#endif // WITH_FILESYSTEM
@@ -0,0 +1,54 @@
+#include "ccv_bindings.h"
+
+// MSER: Maximally stable extremal regions
+
+const ccv_mser_param_t ccv_mser_default_params = { // From ccv/bin/msermatch.c
+  .min_area = 60,
+  .max_area = 10000, // Changed
+  .min_diversity = 0.2,
+  .area_threshold = 1.01,
+  .min_margin = 0.003,
+  .max_evolution = 200,
+  .edge_blur_sigma = sqrt(3.0),
+  .delta = 5,
+  .max_variance = 0.25,
+  .direction = CCV_DARK_TO_BRIGHT,
+};
+
+// ccv_array_t* ccv_mser(ccv_dense_matrix_t* a, ccv_dense_matrix_t* h, ccv_dense_matrix_t** b, int type, ccv_mser_param_t params);
+std::shared_ptr<CCVArray<ccv_mser_keypoint_t>> ccvjs_mser(const std::shared_ptr<ccv_dense_matrix_t>& a, const std::shared_ptr<ccv_dense_matrix_t>& h, std::shared_ptr<ccv_dense_matrix_t>& b, int type, ccv_mser_param_t params = ccv_mser_default_params) {
+  ccv_dense_matrix_t* b_ptr = nullptr;
+  ccv_array_t* ret = ccv_mser(a.get(), h.get(), &b_ptr, type, params);
+  b = make_shared_with_delete(b_ptr);
+  return make_shared_with_delete((CCVArray<ccv_mser_keypoint_t>*)ret);
+}
+
+
+EMSCRIPTEN_BINDINGS(ccv_js_mser_module) {
+  register_ccv_array<ccv_mser_keypoint_t>("ccv_mser_keypoint_array");
+
+  function("ccv_mser", &ccvjs_mser);
+
+  constant("ccv_mser_default_params", ccv_mser_default_params);
+
+  value_object<ccv_mser_param_t>("ccv_mser_param_t")
+    .field("min_area", &ccv_mser_param_t::min_area)
+    .field("max_area", &ccv_mser_param_t::max_area)
+    .field("min_diversity", &ccv_mser_param_t::min_diversity)
+    .field("area_threshold", &ccv_mser_param_t::area_threshold)
+    .field("min_margin", &ccv_mser_param_t::min_margin)
+    .field("max_evolution", &ccv_mser_param_t::max_evolution)
+    .field("edge_blur_sigma", &ccv_mser_param_t::edge_blur_sigma)
+    .field("delta", &ccv_mser_param_t::delta)
+    .field("max_variance", &ccv_mser_param_t::max_variance)
+    .field("direction", &ccv_mser_param_t::direction);
+  value_object<ccv_mser_keypoint_t>("ccv_mser_keypoint_t")
+    .field("keypoint", &ccv_mser_keypoint_t::keypoint)
+    .field("m01", &ccv_mser_keypoint_t::m01)
+    .field("m02", &ccv_mser_keypoint_t::m02)
+    .field("m10", &ccv_mser_keypoint_t::m10)
+    .field("m11", &ccv_mser_keypoint_t::m11)
+    .field("m20", &ccv_mser_keypoint_t::m20)
+    .field("rect", &ccv_mser_keypoint_t::rect)
+    .field("size", &ccv_mser_keypoint_t::size);
+}
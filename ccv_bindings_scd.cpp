@@ -0,0 +1,48 @@
+#include "ccv_bindings.h"
+
+// SCD: SURF-Cascade Detection
+
+#ifdef WITH_FILESYSTEM
+
+template<>
+struct Deleter<ccv_scd_classifier_cascade_t> {
+  void operator()(ccv_scd_classifier_cascade_t* ptr) {
+    //printf("%p %s freed\n", ptr, typeid(ccv_scd_classifier_cascade_t).name());
+    ccv_scd_classifier_cascade_free(ptr);
+  }
+};
+
+
+// ccv_scd_classifier_cascade_t* ccv_scd_classifier_cascade_read(const char* filename);
+std::shared_ptr<ccv_scd_classifier_cascade_t> ccvjs_scd_classifier_cascade_read(const std::string& filename) {
+  return make_shared_with_delete(ccv_scd_classifier_cascade_read(filename.c_str()));
+}
+
+// ccv_array_t* ccv_scd_detect_objects(ccv_dense_matrix_t* a, ccv_scd_classifier_cascade_t** cascades, int count, ccv_scd_param_t params);
+std::shared_ptr<CCVArray<ccv_rect_t>> ccvjs_scd_detect_objects(const std::shared_ptr<ccv_dense_matrix_t>& a, val cascadeJSArray, int count, ccv_scd_param_t params = ccv_scd_default_params) {
+  auto vec = vectorFromJS<ccv_scd_classifier_cascade_t>(cascadeJSArray);
+  return make_shared_with_delete((CCVArray<ccv_rect_t>*)ccv_scd_detect_objects(a.get(), vec.data(), vec.size(), params));
+}
+
+
+EMSCRIPTEN_BINDINGS(ccv_js_scd_module) {
+  class_<ccv_scd_classifier_cascade_t>("ccv_scd_classifier_cascade_t")
+    .smart_ptr_constructor("shared_ptr<ccv_scd_classifier_cascade_t>", &std::make_shared<ccv_scd_classifier_cascade_t>);
+
+  function("ccv_scd_classifier_cascade_read", &ccvjs_scd_classifier_cascade_read);
+  function("ccv_scd_detect_objects", &ccvjs_scd_detect_objects);
+
+  // Location of the trained model in the emscripten filesystem. The build embeds it there.
+  std::string CCV_SCD_FACE_FILE = "/face.sqlite3";
+  constant("CCV_SCD_FACE_FILE", CCV_SCD_FACE_FILE);
+
+  constant("ccv_scd_default_params", ccv_scd_default_params);
+
+  value_object<ccv_scd_param_t>("ccv_scd_param_t")
+    .field("min_neighbors", &ccv_scd_param_t::min_neighbors)
+    .field("step_through", &ccv_scd_param_t::step_through)
+    .field("interval", &ccv_scd_param_t::interval)
+    .field("size", &ccv_scd_param_t::size);
+}
+
+#endif // WITH_FILESYSTEM
@@ -0,0 +1,71 @@
+#include "ccv_bindings.h"
+
+// SIFT: Scale Invariant Feature Transform
+
+// void ccv_sift(ccv_dense_matrix_t* a, ccv_array_t** keypoints, ccv_dense_matrix_t** desc, int type, ccv_sift_param_t params);
+void ccvjs_sift(const std::shared_ptr<ccv_dense_matrix_t>& a, std::shared_ptr<CCVArray<ccv_keypoint_t>>& keypoints, std::shared_ptr<ccv_dense_matrix_t>& desc, int type, ccv_sift_param_t params = ccv_sift_default_params) {
+  ccv_array_t* keypoints_ptr = nullptr;
+  ccv_dense_matrix_t* desc_ptr = nullptr;
+  ccv_sift(a.get(), &keypoints_ptr, &desc_ptr, type, params);
+  keypoints = make_shared_with_delete((CCVArray<ccv_keypoint_t>*)keypoints_ptr);
+  desc = make_shared_with_delete(desc_ptr);
+}
+
+// From ccv/bin/siftmatch.c
+val ccvjs_sift_match(const std::shared_ptr<ccv_dense_matrix_t>& desc1, const std::shared_ptr<CCVArray<ccv_keypoint_t>>& kp1, const std::shared_ptr<ccv_dense_matrix_t>& desc2, const std::shared_ptr<CCVArray<ccv_keypoint_t>>& kp2) {
+  double ratio = 0.36;
+
+  ccv_array_t* image_keypoints = kp1.get();
+  ccv_dense_matrix_t* image_desc = desc1.get();
+  ccv_array_t* obj_keypoints = kp2.get();
+  ccv_dense_matrix_t* obj_desc = desc2.get();
+
+  int i, j, k;
+  val matches = val::array();
+  for (i = 0; i < obj_keypoints->rnum; i++) {
+    float* odesc = obj_desc->data.f32 + i * 128;
+    int minj = -1;
+    double mind = 1e6, mind2 = 1e6;
+    for (j = 0; j < image_keypoints->rnum; j++) {
+      float* idesc = image_desc->data.f32 + j * 128;
+      double d = 0;
+      for (k = 0; k < 128; k++) {
+        d += (odesc[k] - idesc[k]) * (odesc[k] - idesc[k]);
+        if (d > mind2)
+          break;
+      }
+      if (d < mind) {
+        mind2 = mind;
+        mind = d;
+        minj = j;
+      } else if (d < mind2) {
+        mind2 = d;
+      }
+    }
+    if (mind < mind2 * ratio) {
+      //ccv_keypoint_t* op = (ccv_keypoint_t*)ccv_array_get(obj_keypoints, i);
+      //ccv_keypoint_t* kp = (ccv_keypoint_t*)ccv_array_get(image_keypoints, minj);
+      val pair = val::array();
+      pair.call<void>("push", minj);
+      pair.call<void>("push", i);
+      matches.call<void>("push", pair);
+    }
+  }
+  return matches;
+}
+
+
+EMSCRIPTEN_BINDINGS(ccv_js_sift_module) {
+  function("ccv_sift", &ccvjs_sift);
+  function("ccv_sift_match", &ccvjs_sift_match);
+
+  constant("ccv_sift_default_params", ccv_sift_default_params);
+
+  value_object<ccv_sift_param_t>("ccv_sift_param_t")
+    .field("up2x", &ccv_sift_param_t::up2x)
+    .field("noctaves", &ccv_sift_param_t::noctaves)
+    .field("nlevels", &ccv_sift_param_t::nlevels)
+    .field("edge_threshold", &ccv_sift_param_t::edge_threshold)
+    .field("peak_threshold", &ccv_sift_param_t::peak_threshold)
+    .field("norm_threshold", &ccv_sift_param_t::norm_threshold);
+}
@@ -0,0 +1,207 @@
+#include "ccv_bindings.h"
+#include <cmath>
+
+// SWT: Stroke Width Transform
+
+// ccv_array_t* ccv_swt_detect_words(ccv_dense_matrix_t* a, ccv_swt_param_t params);
+std::shared_ptr<CCVArray<ccv_rect_t>> ccvjs_swt_detect_words(const std::shared_ptr<ccv_dense_matrix_t>& a, ccv_swt_param_t params = ccv_swt_default_params) {
+  return make_shared_with_delete((CCVArray<ccv_rect_t>*)ccv_swt_detect_words(a.get(), params));
+}
+
+
+// Scale invariant SWT split into one task per scale level, so the levels can run one at a time with the partial results
+// handed back in between (see Module.swtDetectWordsIncremental in ccv_pre.js) or on separate workers that each have
+// their own ccv_swt_words_t (see Module.createSwtWorkerPool). A final merge groups the words found on different levels.
+// Each task runs ccv_swt_detect_words on its level, which does both the dark to bright and bright to dark passes.
+// The levels come from a pyramid like the one ccv_swt_detect_words builds: every interval + 1 levels is an octave made
+// with ccv_sample_down from the previous octave, and the levels in between are resampled from their octave.
+struct ccv_swt_words_t {
+  ccv_swt_param_t params;
+  std::vector<std::shared_ptr<ccv_dense_matrix_t>> octaves; // Octave 0 is the image, the rest are made when first needed
+  std::vector<double> scales; // How much each level is shrunk, level 0 is the image itself
+  std::vector<std::shared_ptr<CCVArray<ccv_rect_t>>> words; // Of each level in image coordinates, null until it has run
+};
+
+int ccv_swt_words_t_get_levels(const std::shared_ptr<ccv_swt_words_t>& swt_words) {
+  return swt_words->scales.size();
+}
+bool ccv_swt_words_t_is_done(const std::shared_ptr<ccv_swt_words_t>& swt_words, int level) {
+  return (bool)swt_words->words.at(level);
+}
+
+// Holds a shared reference to the image rather than a copy. Deleting the js handle of the image (or reading a new
+// image into it, which replaces the matrix) is safe, but writing into its data while levels are still pending is not.
+std::shared_ptr<ccv_swt_words_t> ccvjs_swt_words_new(const std::shared_ptr<ccv_dense_matrix_t>& a, ccv_swt_param_t params = ccv_swt_default_params) {
+  auto swt_words = std::make_shared<ccv_swt_words_t>();
+  swt_words->params = params;
+  swt_words->octaves.push_back(a);
+
+  // Down to where a letter of average height would about fill the image
+  int levels = 1;
+  double scale = pow(2.0, 1.0 / (params.interval + 1.0));
+  if (params.scale_invariant) {
+    int hr = a->rows * 2 / (params.min_height + params.max_height);
+    int wr = a->cols * 2 / (params.min_height + params.max_height);
+    levels = ccv_max(1, (int)(log((double)ccv_max(1, ccv_min(hr, wr))) / log(scale)));
+  }
+  for (int i = 0; i < levels; i++) {
+    swt_words->scales.push_back(pow(scale, i));
+  }
+  swt_words->words.resize(levels);
+  return swt_words;
+}
+
+// Runs one level (if it hasn't run yet) and returns its words in image coordinates
+std::shared_ptr<CCVArray<ccv_rect_t>> ccvjs_swt_words_run_level(const std::shared_ptr<ccv_swt_words_t>& swt_words, int level) {
+  auto& words = swt_words->words.at(level);
+  if (words) {
+    return words;
+  }
+  int next = swt_words->params.interval + 1;
+  int octave = level / next;
+  while ((int)swt_words->octaves.size() <= octave) {
+    ccv_dense_matrix_t* down = nullptr;
+    ccv_sample_down(swt_words->octaves.back().get(), &down, 0, 0, 0);
+    swt_words->octaves.push_back(make_shared_with_delete(down));
+  }
+  ccv_dense_matrix_t* phx = swt_words->octaves[octave].get();
+  ccv_dense_matrix_t* pyr = phx;
+  if (level % next) {
+    double shrink = pow(2.0, (double)(level % next) / next);
+    pyr = nullptr;
+    ccv_resample(phx, &pyr, 0, (int)(phx->rows / shrink), (int)(phx->cols / shrink), CCV_INTER_AREA);
+  }
+
+  // Grouping across levels (min_neighbors) is left to ccvjs_swt_words_merge
+  ccv_swt_param_t params = swt_words->params;
+  params.scale_invariant = 0;
+  params.min_neighbors = 0;
+  ccv_array_t* level_words = ccv_swt_detect_words(pyr, params);
+  if (pyr != phx) {
+    ccv_matrix_free(pyr);
+  }
+  double scale = swt_words->scales[level];
+  for (int i = 0; i < level_words->rnum; i++) {
+    ccv_rect_t* rect = (ccv_rect_t*)ccv_array_get(level_words, i);
+    rect->x = (int)(rect->x * scale + 0.5);
+    rect->y = (int)(rect->y * scale + 0.5);
+    rect->width = (int)(rect->width * scale + 0.5);
+    rect->height = (int)(rect->height * scale + 0.5);
+  }
+  words = make_shared_with_delete((CCVArray<ccv_rect_t>*)level_words);
+  return words;
+}
+
+// Runs every level that hasn't run yet, biggest first
+void ccvjs_swt_words_run_all(const std::shared_ptr<ccv_swt_words_t>& swt_words) {
+  for (int level = 0; level < (int)swt_words->words.size(); level++) {
+    ccvjs_swt_words_run_level(swt_words, level);
+  }
+}
+
+// Sets the words of a level that ran somewhere else, such as on a worker (see Module.createSwtWorkerPool in ccv_pre.js)
+void ccvjs_swt_words_set_level(const std::shared_ptr<ccv_swt_words_t>& swt_words, int level, const std::shared_ptr<CCVArray<ccv_rect_t>>& words) {
+  swt_words->words.at(level) = words;
+}
+
+// Overlapping more than same_word_thresh[0] of the bigger rect and same_word_thresh[1] of the smaller one
+int ccv_swt_words_is_same(const void* a, const void* b, void* data) {
+  const ccv_rect_t* r1 = (const ccv_rect_t*)a;
+  const ccv_rect_t* r2 = (const ccv_rect_t*)b;
+  const double* thresh = (const double*)data;
+  int width = ccv_min(r1->x + r1->width, r2->x + r2->width) - ccv_max(r1->x, r2->x);
+  int height = ccv_min(r1->y + r1->height, r2->y + r2->height) - ccv_max(r1->y, r2->y);
+  return (
+    width > 0 && height > 0 &&
+    width * height > thresh[0] * ccv_max(r1->width * r1->height, r2->width * r2->height) &&
+    width * height > thresh[1] * ccv_min(r1->width * r1->height, r2->width * r2->height)
+  );
+}
+
+// Merges the words of every level (which all have to have run). Words found on at least min_neighbors levels are
+// averaged into one, the rest are dropped. Without scale_invariant or min_neighbors the words are just concatenated.
+std::shared_ptr<CCVArray<ccv_rect_t>> ccvjs_swt_words_merge(const std::shared_ptr<ccv_swt_words_t>& swt_words) {
+  ccv_array_t* all = ccv_array_new(sizeof(ccv_rect_t), 64, 0);
+  for (const auto& words : swt_words->words) {
+    assert(words); // Run every level first
+    for (int i = 0; i < words->rnum; i++) {
+      ccv_array_push(all, ccv_array_get(words.get(), i));
+    }
+  }
+  ccv_swt_param_t params = swt_words->params;
+  if (!params.scale_invariant || !params.min_neighbors) {
+    return make_shared_with_delete((CCVArray<ccv_rect_t>*)all);
+  }
+
+  ccv_array_t* idx = nullptr;
+  int ncomp = ccv_array_group(all, &idx, ccv_swt_words_is_same, params.same_word_thresh);
+  std::vector<ccv_comp_t> comps(ncomp, ccv_comp_t());
+  for (int i = 0; i < all->rnum; i++) {
+    const ccv_rect_t& rect = *(ccv_rect_t*)ccv_array_get(all, i);
+    ccv_comp_t& comp = comps[*(int*)ccv_array_get(idx, i)];
+    comp.neighbors++;
+    comp.rect.x += rect.x;
+    comp.rect.y += rect.y;
+    comp.rect.width += rect.width;
+    comp.rect.height += rect.height;
+  }
+  ccv_array_t* merged = ccv_array_new(sizeof(ccv_rect_t), ncomp, 0);
+  for (const ccv_comp_t& comp : comps) {
+    int n = comp.neighbors;
+    if (n >= params.min_neighbors) {
+      ccv_rect_t rect = ccv_rect(
+        (comp.rect.x * 2 + n) / (2 * n),
+        (comp.rect.y * 2 + n) / (2 * n),
+        (comp.rect.width * 2 + n) / (2 * n),
+        (comp.rect.height * 2 + n) / (2 * n)
+      );
+      ccv_array_push(merged, &rect);
+    }
+  }
+  ccv_array_free(idx);
+  ccv_array_free(all);
+  return make_shared_with_delete((CCVArray<ccv_rect_t>*)merged);
+}
+
+
+EMSCRIPTEN_BINDINGS(ccv_js_swt_module) {
+  class_<ccv_swt_words_t>("ccv_swt_words_t")
+    .smart_ptr_constructor("shared_ptr<ccv_swt_words_t>", &std::make_shared<ccv_swt_words_t>)
+    .function("levels", &ccv_swt_words_t_get_levels)
+    .function("is_done", &ccv_swt_words_t_is_done);
+
+  function("ccv_swt_detect_words", &ccvjs_swt_detect_words);
+  function("ccv_swt_words_new", &ccvjs_swt_words_new);
+  function("ccv_swt_words_run_level", &ccvjs_swt_words_run_level);
+  function("ccv_swt_words_run_all", &ccvjs_swt_words_run_all);
+  function("ccv_swt_words_set_level", &ccvjs_swt_words_set_level);
+  function("ccv_swt_words_merge", &ccvjs_swt_words_merge);
+
+  constant("ccv_swt_default_params", ccv_swt_default_params);
+
+  register_array<double, 2>("array_double_2"); // For ccv_swt_param_t::same_word_thresh
+  value_object<ccv_swt_param_t>("ccv_swt_param_t")
+    .field("interval", &ccv_swt_param_t::interval)
+    .field("min_neighbors", &ccv_swt_param_t::min_neighbors)
+    .field("scale_invariant", &ccv_swt_param_t::scale_invariant)
+    .field("direction", &ccv_swt_param_t::direction)
+    .field("same_word_thresh", reinterpret_cast<std::array<double, 2> ccv_swt_param_t::*>(&ccv_swt_param_t::same_word_thresh)) // Emscripten doesn't like the type double[2], https://github.com/kripken/emscripten/pull/4510
+    .field("size", &ccv_swt_param_t::size)
+    .field("low_thresh", &ccv_swt_param_t::low_thresh)
+    .field("high_thresh", &ccv_swt_param_t::high_thresh)
+    .field("max_height", &ccv_swt_param_t::max_height)
+    .field("min_height", &ccv_swt_param_t::min_height)
+    .field("min_area", &ccv_swt_param_t::min_area)
+    .field("letter_occlude_thresh", &ccv_swt_param_t::letter_occlude_thresh)
+    .field("aspect_ratio", &ccv_swt_param_t::aspect_ratio)
+    .field("std_ratio", &ccv_swt_param_t::std_ratio)
+    .field("thickness_ratio", &ccv_swt_param_t::thickness_ratio)
+    .field("height_ratio", &ccv_swt_param_t::height_ratio)
+    .field("intensity_thresh", &ccv_swt_param_t::intensity_thresh)
+    .field("distance_ratio", &ccv_swt_param_t::distance_ratio)
+    .field("intersect_ratio", &ccv_swt_param_t::intersect_ratio)
+    .field("elongate_ratio", &ccv_swt_param_t::elongate_ratio)
+    .field("letter_thresh", &ccv_swt_param_t::letter_thresh)
+    .field("breakdown", &ccv_swt_param_t::breakdown)
+    .field("breakdown_ratio", &ccv_swt_param_t::breakdown_ratio);
+}
@@ -0,0 +1,84 @@
+#include "ccv_bindings.h"
+
+// TLD: Track Learn Detect
+
+template<>
+struct Deleter<ccv_tld_t> {
+  void operator()(ccv_tld_t* ptr) {
+    //printf("%p %s freed\n", ptr, typeid(ccv_tld_t).name());
+    ccv_tld_free(ptr);
+  }
+};
+
+
+val ccv_tld_t_get_top(const std::shared_ptr<ccv_tld_t>& ptr) {
+  // Can't just return the ccv_array_t* as a shared_ptr like everywhere else because don't want to take ownership
+  val jsarray = val::array();
+  for (int i = 0; i < ptr->top->rnum; i++) {
+    jsarray.call<void>("push", val(*(ccv_comp_t*)ccv_array_get(ptr->top, i)));
+  }
+  return jsarray;
+}
+
+
+// ccv_tld_t* ccv_tld_new(ccv_dense_matrix_t* a, ccv_rect_t box, ccv_tld_param_t params);
+std::shared_ptr<ccv_tld_t> ccvjs_tld_new(const std::shared_ptr<ccv_dense_matrix_t>& a, ccv_rect_t box, ccv_tld_param_t params = ccv_tld_default_params) {
+  return make_shared_with_delete(ccv_tld_new(a.get(), box, params));
+}
+
+// ccv_comp_t ccv_tld_track_object(ccv_tld_t* tld, ccv_dense_matrix_t* a, ccv_dense_matrix_t* b, ccv_tld_info_t* info);
+ccv_comp_t ccvjs_tld_track_object(const std::shared_ptr<ccv_tld_t>& tld, const std::shared_ptr<ccv_dense_matrix_t>& a, const std::shared_ptr<ccv_dense_matrix_t>& b, const std::shared_ptr<ccv_tld_info_t>& info) {
+  return ccv_tld_track_object(tld.get(), a.get(), b.get(), info.get());
+}
+
+
+EMSCRIPTEN_BINDINGS(ccv_js_tld_module) {
+  class_<ccv_tld_t>("ccv_tld_t")
+    .smart_ptr_constructor("shared_ptr<ccv_tld_t>", &std::make_shared<ccv_tld_t>)
+    .function("top", &ccv_tld_t_get_top);
+  class_<ccv_tld_info_t>("ccv_tld_info_t")
+    .smart_ptr_constructor("shared_ptr<ccv_tld_info_t>", &std::make_shared<ccv_tld_info_t>)
+    .property("perform_track", &ccv_tld_info_t::perform_track)
+    .property("perform_learn", &ccv_tld_info_t::perform_learn)
+    .property("track_success", &ccv_tld_info_t::track_success)
+    .property("ferns_detects", &ccv_tld_info_t::ferns_detects)
+    .property("nnc_detects", &ccv_tld_info_t::nnc_detects)
+    .property("clustered_detects", &ccv_tld_info_t::clustered_detects)
+    .property("confident_matches", &ccv_tld_info_t::confident_matches)
+    .property("close_matches", &ccv_tld_info_t::close_matches);
+
+  function("ccv_tld_new", &ccvjs_tld_new);
+  function("ccv_tld_track_object", &ccvjs_tld_track_object);
+
+  constant("ccv_tld_default_params", ccv_tld_default_params);
+
+  value_object<ccv_tld_param_t>("ccv_tld_param_t")
+    .field("win_size", &ccv_tld_param_t::win_size)
+    .field("level", &ccv_tld_param_t::level)
+    .field("min_forward_backward_error", &ccv_tld_param_t::min_forward_backward_error)
+    .field("min_eigen", &ccv_tld_param_t::min_eigen)
+    .field("min_win", &ccv_tld_param_t::min_win)
+    .field("interval", &ccv_tld_param_t::interval)
+    .field("shift", &ccv_tld_param_t::shift)
+    .field("top_n", &ccv_tld_param_t::top_n)
+    .field("rotation", &ccv_tld_param_t::rotation)
+    .field("include_overlap", &ccv_tld_param_t::include_overlap)
+    .field("exclude_overlap", &ccv_tld_param_t::exclude_overlap)
+    .field("structs", &ccv_tld_param_t::structs)
+    .field("features", &ccv_tld_param_t::features)
+    .field("validate_set", &ccv_tld_param_t::validate_set)
+    .field("nnc_same", &ccv_tld_param_t::nnc_same)
+    .field("nnc_thres", &ccv_tld_param_t::nnc_thres)
+    .field("nnc_verify", &ccv_tld_param_t::nnc_verify)
+    .field("nnc_beyond", &ccv_tld_param_t::nnc_beyond)
+    .field("nnc_collect", &ccv_tld_param_t::nnc_collect)
+    .field("bad_patches", &ccv_tld_param_t::bad_patches)
+    .field("new_deform", &ccv_tld_param_t::new_deform)
+    .field("track_deform", &ccv_tld_param_t::track_deform)
+    .field("new_deform_angle", &ccv_tld_param_t::new_deform_angle)
+    .field("track_deform_angle", &ccv_tld_param_t::track_deform_angle)
+    .field("new_deform_scale", &ccv_tld_param_t::new_deform_scale)
+    .field("track_deform_scale", &ccv_tld_param_t::track_deform_scale)
+    .field("new_deform_shift", &ccv_tld_param_t::new_deform_shift)
+    .field("track_deform_shift", &ccv_tld_param_t::track_deform_shift);
+}
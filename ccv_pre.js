@@ -77,3 +77,546 @@ Module.writeImageData = function(dest, data, width, height) {
   }
 };
 
+
+// Scoped allocations
+//
+// Every handle (a js object wrapping a shared_ptr) created with `new` on a bound class or returned from a bound
+// function is registered with the innermost active scope. When the scope exits, every handle still registered with it
+// is deleted, so temporaries can't leak even if an exception is thrown halfway through a frame:
+//
+//   const rects = CCV.scope(() => {
+//     const image = new CCV.ccv_dense_matrix_t(); // deleted when the scope exits
+//     CCV.ccv_read(video, image);
+//     return CCV.escape(CCV.ccv_swt_detect_words(image, params)); // moved to the enclosing scope (if any)
+//   });
+//
+// Handles created outside of any scope (or escaped out of the outermost one) still have to be deleted by hand. As a
+// backstop they are registered with a FinalizationRegistry (where supported) which frees them when they get garbage
+// collected and reports them as leaks. Set `captureLeakStacks: true` in the Module options to include where each leaked
+// handle was allocated.
+
+Module.scopeStack = [];
+Module.leakStats = {
+  scopeDeleted: 0, // Deleted when their scope exited
+  escaped: 0, // Escaped into an enclosing scope or out of the outermost one
+  leaked: 0, // Garbage collected without being deleted
+};
+
+Module.isHandle = function(x) {
+  return (
+    x instanceof Object &&
+    typeof x.delete === 'function' &&
+    typeof x.isDeleted === 'function' &&
+    x.$$ !== undefined
+  );
+};
+
+Module.reportLeak = function(leak) {
+  console.warn('ccv.js: ' + leak.type + ' was garbage collected without calling delete()' + (leak.stack ? '\n' + leak.stack : ''));
+};
+
+// Mirrors embind's releaseClassHandle since the handle itself is gone by the time we get called
+Module.leakRegistry = (typeof FinalizationRegistry === 'undefined') ? null : new FinalizationRegistry(function(leak) {
+  Module.leakStats.leaked++;
+  Module.reportLeak(leak);
+  var $$ = leak.$$;
+  $$.count.value -= 1;
+  if ($$.count.value === 0) {
+    if ($$.smartPtr) {
+      $$.smartPtrType.rawDestructor($$.smartPtr);
+    } else {
+      $$.ptrType.registeredClass.rawDestructor($$.ptr);
+    }
+  }
+});
+
+Module.attachLeakFinalizer = function(handle) {
+  if (!Module.leakRegistry) {
+    return;
+  }
+  Module.leakRegistry.register(handle, {
+    $$: handle.$$,
+    type: handle.constructor.name,
+    stack: Module.captureLeakStacks ? new Error().stack : null,
+  }, handle);
+};
+
+// Calls fn on every handle in x, searching arrays and plain objects (such as the outputs of ccv_pipeline_run). Returns a
+// copy of x with each handle replaced by what fn returned, anything else is passed through untouched.
+Module.forEachHandle = function(x, fn) {
+  if (Array.isArray(x)) {
+    return x.map(function(y) {
+      return Module.forEachHandle(y, fn);
+    });
+  }
+  if (x instanceof Object && Object.getPrototypeOf(x) === Object.prototype) {
+    var copy = {};
+    Object.keys(x).forEach(function(key) {
+      copy[key] = Module.forEachHandle(x[key], fn);
+    });
+    return copy;
+  }
+  return Module.isHandle(x) ? fn(x) : x;
+};
+
+// Registers the handles with the innermost scope
+Module.track = function(x) {
+  Module.forEachHandle(x, function(handle) {
+    var stack = Module.scopeStack;
+    if (stack.length) {
+      stack[stack.length - 1].push(handle);
+    } else {
+      Module.attachLeakFinalizer(handle);
+    }
+  });
+  return x;
+};
+
+// Moves the handle out of the innermost scope so it survives the scope exiting
+Module.escape = function(handle) {
+  var stack = Module.scopeStack;
+  if (!stack.length) {
+    throw new Error('escape() called outside of a scope');
+  }
+  var scope = stack[stack.length - 1];
+  var i = scope.indexOf(handle);
+  if (i === -1) { // Already escaped, or not allocated in this scope
+    throw new Error('escape() called on a handle not owned by the current scope');
+  }
+  scope.splice(i, 1);
+  if (stack.length > 1) {
+    stack[stack.length - 2].push(handle);
+  } else {
+    Module.attachLeakFinalizer(handle);
+  }
+  Module.leakStats.escaped++;
+  return handle;
+};
+
+// Runs fn synchronously and deletes every handle allocated during it that wasn't escaped
+Module.scope = function(fn) {
+  var scope = [];
+  Module.scopeStack.push(scope);
+  try {
+    return fn();
+  } finally {
+    console.assert(Module.scopeStack[Module.scopeStack.length - 1] === scope, 'Scopes exited out of order');
+    Module.scopeStack.pop();
+    scope.forEach(function(handle) {
+      if (!handle.isDeleted() && !handle.$$.deleteScheduled) {
+        handle.delete();
+        Module.leakStats.scopeDeleted++;
+      }
+    });
+  }
+};
+
+// Wraps the bound classes and functions so everything they hand back gets tracked. Needs to run after the
+// EMSCRIPTEN_BINDINGS have been registered.
+Module.installScopeTracking = function() {
+  var wrapFunction = function(fn) {
+    var wrapped = function() {
+      return Module.track(fn.apply(this, arguments));
+    };
+    wrapped.isScopeTracked = true;
+    Object.keys(fn).forEach(function(key) { // Embind looks up overloadTable on whatever is currently exposed
+      wrapped[key] = fn[key];
+    });
+    return wrapped;
+  };
+  var wrapClass = function(cls) {
+    var wrapped = function() {
+      var args = [null].concat(Array.prototype.slice.call(arguments));
+      return Module.track(new (Function.prototype.bind.apply(cls, args))());
+    };
+    wrapped.isScopeTracked = true;
+    wrapped.prototype = cls.prototype; // So instanceof still works
+    Object.keys(cls).forEach(function(key) { // Class functions such as fromJS
+      wrapped[key] = (typeof cls[key] === 'function') ? wrapFunction(cls[key]) : cls[key];
+    });
+    return wrapped;
+  };
+
+  Object.keys(Module).filter(function(name) {
+    return name.indexOf('ccv_') === 0 && typeof Module[name] === 'function' && !Module[name].isScopeTracked;
+  }).forEach(function(name) {
+    var binding = Module[name];
+    var isClass = binding.prototype && typeof binding.prototype.delete === 'function';
+    Module[name] = isClass ? wrapClass(binding) : wrapFunction(binding);
+  });
+
+  // Every bound class ultimately inherits from embind's ClassHandle
+  var classHandlePrototype = Module.ccv_array_t.prototype;
+  while (Object.getPrototypeOf(classHandlePrototype) !== Object.prototype) {
+    classHandlePrototype = Object.getPrototypeOf(classHandlePrototype);
+  }
+  if (classHandlePrototype.delete.isScopeTracked) {
+    return;
+  }
+  var originalDelete = classHandlePrototype.delete;
+  classHandlePrototype.delete = function() {
+    if (Module.leakRegistry) {
+      Module.leakRegistry.unregister(this);
+    }
+    return originalDelete.apply(this, arguments);
+  };
+  classHandlePrototype.delete.isScopeTracked = true;
+  var originalClone = classHandlePrototype.clone;
+  classHandlePrototype.clone = function() {
+    return Module.track(originalClone.apply(this, arguments));
+  };
+};
+
+
+Module.onRuntimeInitialized = (function(onRuntimeInitialized) {
+  return function() {
+    Module.installScopeTracking();
+    if (onRuntimeInitialized) {
+      onRuntimeInitialized();
+    }
+  };
+})(Module.onRuntimeInitialized);
+
+
+// Motion gating
+//
+// Wraps a detector so it only runs on frames where ccv_motion_gate_update found changed tiles. For every other frame the
+// results of the last run are handed back (as clones, so deleting them or letting a scope delete them is fine):
+//
+//   const detect = CCV.motionGated((image, tiles) => CCV.ccv_scd_detect_objects(image, cascade, 1, params));
+//   CCV.scope(() => {
+//     const image = new CCV.ccv_dense_matrix_t();
+//     CCV.ccv_read(video, image);
+//     const rects = detect(image);
+//   });
+//   console.log(detect.stats()); // How many frames were skipped and how many tiles didn't change
+//   detect.delete();
+//
+// `tiles` is a js array of the ccv_rect_t that changed, for detectors that can get away with only looking at those.
+// `params` is an optional ccv_motion_gate_param_t (see ccv_motion_gate_default_params).
+
+// Takes the handles out of whichever scope owns them so they outlive it. Like handles allocated outside of any scope they
+// get the leak finalizer as a backstop.
+Module.untrack = function(x) {
+  Module.forEachHandle(x, function(handle) {
+    for (var i = Module.scopeStack.length - 1; i >= 0; i--) {
+      var scope = Module.scopeStack[i];
+      var j = scope.indexOf(handle);
+      if (j !== -1) {
+        scope.splice(j, 1);
+        Module.attachLeakFinalizer(handle);
+        return;
+      }
+    }
+  });
+  return x;
+};
+
+Module.cloneHandles = function(x) {
+  return Module.forEachHandle(x, function(handle) {
+    return handle.clone(); // clone() tracks the copy
+  });
+};
+
+Module.deleteHandles = function(x) {
+  Module.forEachHandle(x, function(handle) {
+    if (!handle.isDeleted()) {
+      handle.delete();
+    }
+  });
+};
+
+Module.motionGated = function(detect, params) {
+  var gate = Module.untrack(new Module.ccv_motion_gate_t());
+  var hasCache = false;
+  var cache; // Owned by us, never handed out directly
+
+  var gated = function(image) {
+    if (Module.ccv_motion_gate_update(gate, image, params || Module.ccv_motion_gate_default_params) > 0 || !hasCache) {
+      var results;
+      try {
+        results = Module.untrack(detect(image, gate.changed_tiles()));
+      } catch (e) {
+        // The gate already took this frame as its reference so drop the stale results and rerun on the next one
+        gated.reset();
+        throw e;
+      }
+      Module.deleteHandles(cache);
+      cache = results;
+      hasCache = true;
+    }
+    return Module.cloneHandles(cache);
+  };
+  gated.gate = gate;
+  gated.stats = function() {
+    return gate.stats();
+  };
+  // Next frame runs the detector again, e.g. after changing its params
+  gated.reset = function() {
+    gate.reset();
+    Module.deleteHandles(cache);
+    cache = undefined;
+    hasCache = false;
+  };
+  gated.delete = function() {
+    Module.deleteHandles(cache);
+    gate.delete();
+  };
+  return gated;
+};
+
+
+// Incremental SWT
+//
+// Runs the scale levels of a ccv_swt_words_t one at a time, smallest (and fastest) first, yielding to the browser in
+// between so the words found so far can be drawn while the bigger levels are still running:
+//
+//   CCV.swtDetectWordsIncremental(image, params, (rects, level, levels) => draw(rects.toJS()))
+//     .then((rects) => {
+//       draw(rects.toJS()); // Merged over every level
+//       rects.delete();
+//     });
+//
+// The partial arrays given to the callback are deleted once it returns. The ccv_swt_words_t holds a shared reference
+// to the image, not a copy: deleting its handle or reading a new image into it is safe, but don't write into its
+// get_data() until the promise settles.
+Module.swtDetectWordsIncremental = function(image, params, onLevel) {
+  var swtWords = Module.untrack(Module.ccv_swt_words_new(image, params || Module.ccv_swt_default_params));
+  var levels = swtWords.levels();
+  var next = function(level) {
+    if (level < 0) {
+      return Module.untrack(Module.ccv_swt_words_merge(swtWords));
+    }
+    return new Promise(function(resolve) {
+      setTimeout(resolve, 0);
+    }).then(function() {
+      var words = Module.untrack(Module.ccv_swt_words_run_level(swtWords, level));
+      try {
+        if (onLevel) {
+          onLevel(words, level, levels);
+        }
+      } finally {
+        words.delete();
+      }
+      return next(level - 1);
+    });
+  };
+  return next(levels - 1).then(function(merged) {
+    swtWords.delete();
+    return merged;
+  }, function(e) {
+    swtWords.delete();
+    throw e;
+  });
+};
+
+
+// SWT on workers
+//
+// Runs the scale levels of SWT in parallel on a pool of web workers, each with its own instance of the library. Every
+// worker keeps a ccv_swt_words_t per job for the levels it gets, and the words of each level are sent back and merged
+// on the main thread:
+//
+//   const pool = CCV.createSwtWorkerPool('build/ccv.js', navigator.hardwareConcurrency);
+//   pool.detectWords(image, params, (rects, level, levels) => draw(rects.toJS()))
+//     .then((rects) => {
+//       draw(rects.toJS()); // Merged over every level
+//       rects.delete();
+//     });
+//   pool.terminate(); // When done with it
+//
+// Levels are handed out biggest (and slowest) first, so the small ones fill in at the end. The image is copied to the
+// workers before detectWords returns. The partial arrays given to the callback are deleted once it returns.
+
+// Answers the messages of Module.createSwtWorkerPool. Runs on the worker.
+Module.serveSwtWorker = function(scope) {
+  var jobs = {}; // ccv_swt_words_t of each job
+  scope.onmessage = function(e) {
+    var msg = e.data;
+    if (msg.type === 'release') {
+      if (jobs[msg.job]) {
+        jobs[msg.job].delete();
+        delete jobs[msg.job];
+      }
+      return;
+    }
+    try {
+      var rects = Module.scope(function() {
+        if (!jobs[msg.job]) { // The image only comes with the first level of a job
+          var image = new Module.ccv_dense_matrix_t();
+          Module.ccv_read(msg.imageData, image, Module.CCV_IO_GRAY);
+          jobs[msg.job] = Module.untrack(Module.ccv_swt_words_new(image, msg.params));
+        }
+        return Module.ccv_swt_words_run_level(jobs[msg.job], msg.level).toJS();
+      });
+      scope.postMessage({ type: 'words', job: msg.job, level: msg.level, rects: rects });
+    } catch (err) {
+      scope.postMessage({ type: 'error', job: msg.job, level: msg.level, message: String(err && err.message || err) });
+    }
+  };
+  scope.postMessage({ type: 'ready' });
+};
+
+// `scriptUrl` is where this library's js file is (the wasm build looks for its .wasm file next to it). `size` defaults
+// to the number of cores.
+Module.createSwtWorkerPool = function(scriptUrl, size) {
+  var url = new URL(scriptUrl, location.href).href;
+  var base = url.slice(0, url.lastIndexOf('/') + 1);
+  var source = (
+    'importScripts(' + JSON.stringify(url) + ');\n' +
+    'var CCV = {\n' +
+    '  locateFile: function(path) { return ' + JSON.stringify(base) + ' + path; },\n' +
+    '  onRuntimeInitialized: function() { CCV.serveSwtWorker(self); },\n' +
+    '};\n' +
+    'CCVLib(CCV);\n'
+  );
+  var workerUrl = URL.createObjectURL(new Blob([source], { type: 'application/javascript' }));
+
+  var workers = [];
+  var queue = []; // Levels that haven't been handed out yet
+  var jobs = {};
+  var nextJob = 0;
+
+  var release = function(id) {
+    var job = jobs[id];
+    delete jobs[id];
+    queue = queue.filter(function(task) {
+      return task.job !== id;
+    });
+    workers.forEach(function(w) {
+      if (w.jobs[id]) {
+        delete w.jobs[id];
+        w.worker.postMessage({ type: 'release', job: id });
+      }
+    });
+    job.swtWords.delete();
+    return job;
+  };
+
+  var fail = function(id, err) {
+    if (jobs[id]) {
+      release(id).reject(err);
+    }
+  };
+
+  var receiveWords = function(id, level, rects) {
+    var job = jobs[id];
+    var words = Module.untrack(Module.ccv_rect_array.fromJS(rects));
+    try {
+      Module.ccv_swt_words_set_level(job.swtWords, level, words);
+      if (job.onLevel) {
+        job.onLevel(words, level, job.levels);
+      }
+    } catch (err) {
+      fail(id, err);
+      return;
+    } finally {
+      words.delete();
+    }
+    if (--job.remaining === 0) {
+      var merged = Module.untrack(Module.ccv_swt_words_merge(job.swtWords));
+      release(id).resolve(merged);
+    }
+  };
+
+  var dispatch = function() {
+    workers.forEach(function(w) {
+      if (!w.ready || w.task || !queue.length) {
+        return;
+      }
+      var task = queue.shift();
+      var msg = { type: 'level', job: task.job, level: task.level, params: jobs[task.job].params };
+      if (!w.jobs[task.job]) {
+        msg.imageData = jobs[task.job].imageData;
+        w.jobs[task.job] = true;
+      }
+      w.task = task;
+      w.worker.postMessage(msg);
+    });
+  };
+
+  var remove = function(w) {
+    workers.splice(workers.indexOf(w), 1);
+    w.worker.terminate();
+    if (!workers.length) { // Nothing left to run the queued levels on
+      Object.keys(jobs).forEach(function(id) {
+        fail(Number(id), new Error('Every SWT worker failed to start'));
+      });
+    }
+  };
+
+  for (var i = 0; i < (size || navigator.hardwareConcurrency || 4); i++) {
+    (function(w) {
+      w.worker.onmessage = function(e) {
+        var msg = e.data;
+        if (msg.type === 'ready') {
+          w.ready = true;
+        } else {
+          w.task = null;
+          if (!jobs[msg.job]) {
+            // Failed or released while this level was running
+          } else if (msg.type === 'error') {
+            fail(msg.job, new Error(msg.message));
+          } else {
+            receiveWords(msg.job, msg.level, msg.rects);
+          }
+        }
+        dispatch();
+      };
+      w.worker.onerror = function(e) {
+        e.preventDefault();
+        var err = new Error(e.message);
+        if (w.task) {
+          fail(w.task.job, err);
+          w.task = null;
+        }
+        if (!w.ready) { // Couldn't load the library
+          remove(w);
+        }
+        dispatch();
+      };
+      workers.push(w);
+    })({ worker: new Worker(workerUrl), ready: false, task: null, jobs: {} });
+  }
+
+  var pool = {};
+  pool.detectWords = function(image, params, onLevel) {
+    params = params || Module.ccv_swt_default_params;
+    var imageData = new ImageData(image.get_cols(), image.get_rows());
+    Module.ccv_write(image, imageData);
+    // Only used for the number of levels and the merge, the levels themselves run on the workers
+    var swtWords = Module.untrack(Module.ccv_swt_words_new(image, params));
+    var id = nextJob++;
+    return new Promise(function(resolve, reject) {
+      var levels = swtWords.levels();
+      jobs[id] = {
+        imageData: imageData,
+        params: params,
+        swtWords: swtWords,
+        levels: levels,
+        remaining: levels,
+        onLevel: onLevel,
+        resolve: resolve,
+        reject: reject,
+      };
+      for (var level = 0; level < levels; level++) {
+        queue.push({ job: id, level: level });
+      }
+      if (!workers.length) {
+        fail(id, new Error('Every SWT worker failed to start'));
+      }
+      dispatch();
+    });
+  };
+  pool.terminate = function() {
+    Object.keys(jobs).forEach(function(id) {
+      fail(Number(id), new Error('SWT worker pool terminated'));
+    });
+    workers.forEach(function(w) {
+      w.worker.terminate();
+    });
+    workers = [];
+    URL.revokeObjectURL(workerUrl);
+  };
+  return pool;
+};